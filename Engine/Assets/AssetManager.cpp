@@ -0,0 +1,310 @@
+#include "AssetManager.h"
+#include "Engine/Profiler/Profiler.h"
+#include "Util/Log.h"
+#include <chrono>
+#include <limits>
+
+namespace {
+	// an edited file jumps every streaming request, it is what the user is looking at
+	constexpr int ReloadPriority = std::numeric_limits<int>::max();
+}
+
+/* MeshRef */
+
+MeshRef::MeshRef(AssetManager* manager, uint32_t index)
+	: manager{ manager }, index{ index } {}
+
+MeshRef::MeshRef(const MeshRef& other)
+	: manager{ other.manager }, index{ other.index } {
+	if (manager) {
+		manager->AddRef(index);
+	}
+}
+
+MeshRef::MeshRef(MeshRef&& other) noexcept
+	: manager{ other.manager }, index{ other.index } {
+	other.manager = nullptr;
+}
+
+MeshRef& MeshRef::operator=(MeshRef other) noexcept {
+	std::swap(manager, other.manager);
+	std::swap(index, other.index);
+	return *this;
+}
+
+MeshRef::~MeshRef() {
+	if (manager) {
+		manager->Release(index);
+	}
+}
+
+// references that outlive Shutdown point past the cleared entries and behave like empty ones
+MeshHandle MeshRef::Mesh() const {
+	if (!manager || index >= manager->entries.size()) {
+		return InvalidMesh;
+	}
+	const AssetManager::Entry* entry = manager->entries[index];
+	return entry ? entry->mesh : InvalidMesh;
+}
+
+bool MeshRef::Ready() const {
+	if (!manager || index >= manager->entries.size()) {
+		return false;
+	}
+	const AssetManager::Entry* entry = manager->entries[index];
+	return entry && entry->uploaded;
+}
+
+/* AssetManager */
+
+AssetManager::~AssetManager() {
+	Shutdown();
+}
+
+bool AssetManager::Initialize(IRenderer* pRenderer, const BasicVertex* placeholderVertices, uint32_t placeholderVertexCount,
+	const uint32_t* placeholderIndices, uint32_t placeholderIndexCount, uint32_t ioThreads) {
+	if (!pRenderer || ioThreads == 0) {
+		Log.error("[Assets] a renderer and at least one I/O thread are required");
+		return false;
+	}
+	this->pRenderer = pRenderer;
+	this->placeholderVertices.assign(placeholderVertices, placeholderVertices + placeholderVertexCount);
+	this->placeholderIndices.assign(placeholderIndices, placeholderIndices + placeholderIndexCount);
+
+	quit = false;
+	for (uint32_t i = 0; i < ioThreads; ++i) {
+		this->ioThreads.emplace_back(&AssetManager::IoLoop, this);
+	}
+	Log.info("[Assets] streaming on " + std::to_string(ioThreads) + " I/O threads");
+	return true;
+}
+
+void AssetManager::Shutdown() {
+	{
+		std::lock_guard<std::mutex> lock{ requestMutex };
+		quit = true;
+	}
+	requestReady.notify_all();
+	for (std::thread& thread : ioThreads) {
+		thread.join();
+	}
+	ioThreads.clear();
+
+	// the renderer frees its meshes itself, only the mappings and bookkeeping go here
+	requests = {};
+	loaded = {};
+	for (Entry* entry : entries) {
+		entryPool.Destroy(entry);
+	}
+	entries.clear();
+	freeEntries.clear();
+	entriesByPath.clear();
+	pendingCount.store(0, std::memory_order_relaxed);
+	pRenderer = nullptr;
+}
+
+MeshRef AssetManager::RequestMesh(const std::string& path, int priority) {
+	if (!pRenderer) {
+		return {};
+	}
+
+	auto it = entriesByPath.find(path);
+	if (it != entriesByPath.end()) {
+		AddRef(it->second);
+		return { this, it->second };
+	}
+
+	// the handle is final right away, the placeholder geometry is swapped out in Finalize
+	const MeshHandle mesh = pRenderer->CreateMesh({ placeholderVertices.data(), static_cast<uint32_t>(placeholderVertices.size()),
+		placeholderIndices.data(), static_cast<uint32_t>(placeholderIndices.size()) });
+	if (mesh == InvalidMesh) {
+		Log.error("[Assets] could not create a placeholder for " + path);
+		return {};
+	}
+
+	uint32_t index{};
+	if (!freeEntries.empty()) {
+		index = freeEntries.back();
+		freeEntries.pop_back();
+	}
+	else {
+		index = static_cast<uint32_t>(entries.size());
+		entries.push_back(nullptr);
+	}
+
+	Entry& entry = *entryPool.Create();
+	entries[index] = &entry;
+	entry.index = index;
+	entry.path = path;
+	entry.refs = 1;
+	entry.mesh = mesh;
+	entriesByPath.emplace(path, index);
+
+	Queue(entry, priority);
+	return { this, index };
+}
+
+bool AssetManager::Reload(const std::string& path) {
+	auto it = entriesByPath.find(path);
+	if (it == entriesByPath.end()) {
+		return false;
+	}
+
+	Entry& entry = *entries[it->second];
+	if (entry.inFlight) {
+		// the I/O thread may have read the old contents already, Finalize queues it again
+		entry.reloadQueued = true;
+	}
+	else {
+		Queue(entry, ReloadPriority);
+	}
+	return true;
+}
+
+bool AssetManager::HasFinishedLoads() {
+	std::lock_guard<std::mutex> lock{ loadedMutex };
+	return !loaded.empty();
+}
+
+uint32_t AssetManager::Finalize(float budgetMs) {
+	PROFILE_ZONE("Asset Finalize");
+
+	using Clock = std::chrono::steady_clock;
+	const Clock::time_point start = Clock::now();
+	uint32_t readyCount{ 0 };
+
+	for (;;) {
+		Request request{};
+		{
+			std::lock_guard<std::mutex> lock{ loadedMutex };
+			if (loaded.empty()) {
+				break;
+			}
+			request = loaded.top();
+			loaded.pop();
+		}
+		pendingCount.fetch_sub(1, std::memory_order_relaxed);
+
+		Entry& entry = *request.entry;
+		entry.inFlight = false;
+		if (entry.cancelled.load(std::memory_order_relaxed)) {
+			// every reference went away while it was loading
+			FreeEntry(entry);
+			continue;
+		}
+
+		if (entry.state == State::Loaded
+			&& pRenderer->UpdateMesh(entry.mesh, entry.file.Data())) {
+			entry.state = State::Ready;
+			entry.uploaded = true;
+			++readyCount;
+			if (onMeshLoaded) {
+				onMeshLoaded(entry.mesh, entry.file.Bounds(), entry.file.Data());
+			}
+			Log.info("[Assets] loaded " + entry.path + " (" + std::to_string(entry.file.VertexCount()) + " vertices, "
+				+ std::to_string(entry.file.IndexCount() / 3) + " triangles)");
+		}
+		else {
+			entry.state = State::Failed;
+			Log.warning("[Assets] " + entry.path + " failed to load, keeping the "
+				+ (entry.uploaded ? "previous geometry" : "placeholder"));
+		}
+		entry.file.Close();
+
+		if (entry.reloadQueued) {
+			entry.reloadQueued = false;
+			Queue(entry, ReloadPriority);
+		}
+
+		if (std::chrono::duration<float, std::milli>(Clock::now() - start).count() >= budgetMs) {
+			break;
+		}
+	}
+	return readyCount;
+}
+
+/* private functions */
+
+void AssetManager::Queue(Entry& entry, int priority) {
+	entry.inFlight = true;
+	entry.state = State::Queued;
+	pendingCount.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lock{ requestMutex };
+		requests.push({ priority, requestOrder++, &entry });
+	}
+	requestReady.notify_one();
+}
+
+void AssetManager::IoLoop() {
+	Profiler::SetThreadName("Asset I/O");
+
+	for (;;) {
+		Request request{};
+		{
+			std::unique_lock<std::mutex> lock{ requestMutex };
+			requestReady.wait(lock, [this] { return quit || !requests.empty(); });
+			if (quit) {
+				return;
+			}
+			request = requests.top();
+			requests.pop();
+		}
+
+		Entry& entry = *request.entry;
+		if (!entry.cancelled.load(std::memory_order_relaxed)) {
+			PROFILE_ZONE("Asset Load");
+			if (entry.file.Open(entry.path)) {
+				// Open already touched every index, fault the vertex pages in as well so the
+				// upload in Finalize never waits on the disk
+				constexpr size_t PageSize = 4096;
+				const uint8_t* bytes = static_cast<const uint8_t*>(entry.file.Data().vertices);
+				const size_t size = entry.file.Data().VertexBytes();
+				uint8_t sum{ 0 };
+				for (size_t offset = 0; offset < size; offset += PageSize) {
+					sum += bytes[offset];
+				}
+				volatile uint8_t sink = sum;
+				(void)sink;
+				entry.state = State::Loaded;
+			}
+			else {
+				entry.state = State::Failed;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock{ loadedMutex };
+		loaded.push(request);
+	}
+}
+
+void AssetManager::AddRef(uint32_t index) {
+	++entries[index]->refs;
+}
+
+void AssetManager::Release(uint32_t index) {
+	// references that outlive Shutdown have nothing left to release
+	if (index >= entries.size()) {
+		return;
+	}
+	Entry& entry = *entries[index];
+	if (--entry.refs > 0) {
+		return;
+	}
+
+	entriesByPath.erase(entry.path);
+	if (!entry.inFlight) {
+		FreeEntry(entry);
+	}
+	else {
+		// still with an I/O thread or waiting for Finalize, which frees it once it comes back
+		entry.cancelled.store(true, std::memory_order_relaxed);
+	}
+}
+
+void AssetManager::FreeEntry(Entry& entry) {
+	pRenderer->DestroyMesh(entry.mesh);
+	entries[entry.index] = nullptr;
+	freeEntries.push_back(entry.index);
+	entryPool.Destroy(&entry);
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+//
+// Asset Manager
+// Streams assets in the background:
+// - RequestMesh returns a ref-counted handle right away, drawing it shows a placeholder
+// - I/O threads take requests highest priority first, map and validate the file
+// - Finalize runs on the main thread once per frame and uploads finished loads
+//   to the renderer until its time budget is used up
+// Releasing the last reference cancels a pending load or frees the mesh
+// Reload streams a changed file in again the same way, the old geometry stays until the new one is uploaded
+// Requests, releases and Finalize call into the renderer, so they need it idle
+//
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "MeshFile.h"
+#include "Engine/Memory/Pool.h"
+#include "Engine/Renderer/IRenderer.h"
+#include "Util/Math/Aabb.h"
+
+class AssetManager;
+
+// keeps an asset loaded while any copy exists, copies and destruction must happen on the main thread
+// after AssetManager::Shutdown a reference is empty: Mesh() is InvalidMesh and Ready() false
+class MeshRef {
+public:
+	MeshRef() = default;
+	MeshRef(const MeshRef& other);
+	MeshRef(MeshRef&& other) noexcept;
+	MeshRef& operator=(MeshRef other) noexcept;
+	~MeshRef();
+
+	bool Valid() const { return manager != nullptr; }
+	// stable for the lifetime of the asset, draws the placeholder until the data arrived
+	MeshHandle Mesh() const;
+	bool Ready() const;
+private:
+	friend class AssetManager;
+	MeshRef(AssetManager* manager, uint32_t index);
+
+	AssetManager* manager{ nullptr };
+	uint32_t index{};
+};
+
+class AssetManager {
+public:
+	AssetManager() = default;
+	~AssetManager();
+
+	// placeholder geometry is shown for every mesh until its data is uploaded
+	bool Initialize(IRenderer* pRenderer, const BasicVertex* placeholderVertices, uint32_t placeholderVertexCount,
+		const uint32_t* placeholderIndices, uint32_t placeholderIndexCount, uint32_t ioThreads = 2);
+	void Shutdown();
+
+	// higher priority loads first, requesting a path again shares the asset
+	MeshRef RequestMesh(const std::string& path, int priority = 0);
+
+	// loads a requested path again ahead of every other request, e.g. after the file changed on disk;
+	// false if nothing requested it. Failing keeps the geometry from the last successful load
+	bool Reload(const std::string& path);
+
+	// true when Finalize has uploads to do, the renderer must not be drawing while it runs
+	bool HasFinishedLoads();
+	// uploads finished loads until budgetMs is spent, at least one per call so streaming always progresses
+	// returns the number of assets that became ready
+	uint32_t Finalize(float budgetMs);
+
+	// called from Finalize for every mesh that became ready, with its object space bounds and the
+	// uploaded data, which is only valid during the call
+	void SetMeshLoadedCallback(std::function<void(MeshHandle, const Aabb&, const MeshData&)> callback) { onMeshLoaded = std::move(callback); }
+
+	uint32_t PendingCount() const { return pendingCount.load(std::memory_order_relaxed); }
+private:
+	friend class MeshRef;
+
+	enum class State : uint8_t { Queued, Loaded, Failed, Ready };
+
+	struct Entry {
+		uint32_t index{};
+		std::string path{};              // fixed until the entry is freed
+		uint32_t refs{};                 // main thread only
+		MeshHandle mesh{ InvalidMesh };  // main thread only
+		bool inFlight{ false };          // main thread only, set until Finalize took it back
+		bool uploaded{ false };          // main thread only, the file's geometry replaced the placeholder
+		bool reloadQueued{ false };      // main thread only, reload once the load in flight is finalized
+		State state{ State::Queued };    // written by the I/O thread while in flight
+		std::atomic<bool> cancelled{ false };
+		MeshFile file{};                 // opened by an I/O thread, uploaded and closed in Finalize
+	};
+
+	struct Request {
+		int priority;
+		uint64_t order; // first come first served within a priority
+		Entry* entry;   // entries never move, the vector holding them may
+		bool operator<(const Request& other) const {
+			return priority != other.priority ? priority < other.priority : order > other.order;
+		}
+	};
+
+	IRenderer* pRenderer{ nullptr };
+	std::vector<BasicVertex> placeholderVertices{};
+	std::vector<uint32_t> placeholderIndices{};
+
+	// entries come from the pool so their addresses stay fixed, freed slots are null until reused
+	Pool<Entry> entryPool{};
+	std::vector<Entry*> entries{};
+	std::vector<uint32_t> freeEntries{};
+	std::unordered_map<std::string, uint32_t> entriesByPath{};
+	std::atomic<uint32_t> pendingCount{ 0 };
+
+	/* request queue, filled by the main thread and drained by I/O threads */
+	std::mutex requestMutex{};
+	std::condition_variable requestReady{};
+	std::priority_queue<Request> requests{};
+	uint64_t requestOrder{};
+	bool quit{ false };
+	std::vector<std::thread> ioThreads{};
+
+	/* finished loads waiting for Finalize */
+	std::mutex loadedMutex{};
+	std::priority_queue<Request> loaded{};
+
+	std::function<void(MeshHandle, const Aabb&, const MeshData&)> onMeshLoaded{};
+
+	void Queue(Entry& entry, int priority);
+	void IoLoop();
+	void AddRef(uint32_t index);
+	void Release(uint32_t index);
+	void FreeEntry(Entry& entry);
+};
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include "FileWatcher.h"
+#include "Engine/Profiler/Profiler.h"
+#include "Util/Log.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <filesystem>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::~FileWatcher()
+{
+	Stop();
+}
+
+void FileWatcher::Poll(std::vector<std::string>& changed) {
+	std::lock_guard<std::mutex> lock{ mutex };
+	if (pending.empty()) {
+		return;
+	}
+	const Clock::time_point now = Clock::now();
+	for (auto it = pending.begin(); it != pending.end();) {
+		if (now - it->second >= QuietTime) {
+			changed.push_back(it->first);
+			it = pending.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void FileWatcher::Touch(std::string path) {
+	std::replace(path.begin(), path.end(), '\\', '/');
+	std::lock_guard<std::mutex> lock{ mutex };
+	pending[std::move(path)] = Clock::now();
+}
+
+#ifdef _WIN32
+bool FileWatcher::Start(const std::string& directory) {
+	Stop();
+
+	HANDLE dir = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+	if (dir == INVALID_HANDLE_VALUE) {
+		Log.error("[Watch] could not open " + directory);
+		return false;
+	}
+	hDirectory = dir;
+	hStopEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+
+	this->directory = directory;
+	quit = false;
+	thread = std::thread(&FileWatcher::WatchLoop, this);
+	Log.info("[Watch] watching " + directory + " for changes");
+	return true;
+}
+
+void FileWatcher::Stop() {
+	if (thread.joinable()) {
+		quit = true;
+		SetEvent(hStopEvent);
+		thread.join();
+	}
+	if (hStopEvent) {
+		CloseHandle(hStopEvent);
+	}
+	if (hDirectory) {
+		CloseHandle(hDirectory);
+	}
+	hStopEvent = nullptr;
+	hDirectory = nullptr;
+	pending.clear();
+}
+
+void FileWatcher::WatchLoop() {
+	Profiler::SetThreadName("File Watcher");
+
+	HANDLE changeEvent = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+	alignas(DWORD) uint8_t buffer[16 * 1024];
+	while (!quit) {
+		OVERLAPPED overlapped{};
+		overlapped.hEvent = changeEvent;
+		if (!ReadDirectoryChangesW(hDirectory, buffer, sizeof(buffer), TRUE,
+			FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE,
+			nullptr, &overlapped, nullptr)) {
+			Log.error("[Watch] ReadDirectoryChangesW() failed, stopped watching " + directory);
+			break;
+		}
+
+		HANDLE handles[] = { static_cast<HANDLE>(hStopEvent), changeEvent };
+		DWORD bytes{ 0 };
+		if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1) {
+			// the read must finish before buffer and overlapped go out of scope
+			CancelIo(hDirectory);
+			GetOverlappedResult(hDirectory, &overlapped, &bytes, TRUE);
+			break;
+		}
+		if (!GetOverlappedResult(hDirectory, &overlapped, &bytes, FALSE) || bytes == 0) {
+			// zero bytes means the buffer overflowed and the changes were dropped, nothing to reload
+			continue;
+		}
+
+		for (const uint8_t* entry = buffer;;) {
+			const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(entry);
+			if (info->Action != FILE_ACTION_REMOVED && info->Action != FILE_ACTION_RENAMED_OLD_NAME) {
+				const int wideLength = static_cast<int>(info->FileNameLength / sizeof(WCHAR));
+				const int length = WideCharToMultiByte(CP_UTF8, 0, info->FileName, wideLength, nullptr, 0, nullptr, nullptr);
+				std::string name(static_cast<size_t>(length), '\0');
+				WideCharToMultiByte(CP_UTF8, 0, info->FileName, wideLength, name.data(), length, nullptr, nullptr);
+				Touch(directory + "/" + name);
+			}
+			if (info->NextEntryOffset == 0) {
+				break;
+			}
+			entry += info->NextEntryOffset;
+		}
+	}
+	CloseHandle(changeEvent);
+}
+#else
+bool FileWatcher::Start(const std::string& directory) {
+	Stop();
+
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotifyFd < 0) {
+		Log.error("[Watch] inotify_init1() failed");
+		return false;
+	}
+	if (!AddWatches(directory)) {
+		Log.error("[Watch] could not watch " + directory);
+		Stop();
+		return false;
+	}
+
+	this->directory = directory;
+	quit = false;
+	thread = std::thread(&FileWatcher::WatchLoop, this);
+	Log.info("[Watch] watching " + directory + " (" + std::to_string(watchedDirectories.size()) + " directories) for changes");
+	return true;
+}
+
+void FileWatcher::Stop() {
+	if (thread.joinable()) {
+		quit = true;
+		thread.join();
+	}
+	if (inotifyFd >= 0) {
+		close(inotifyFd);
+	}
+	inotifyFd = -1;
+	watchedDirectories.clear();
+	pending.clear();
+}
+
+// inotify is not recursive, every directory needs its own watch
+bool FileWatcher::AddWatches(const std::string& root) {
+	constexpr uint32_t mask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_MOVED_TO;
+	const int wd = inotify_add_watch(inotifyFd, root.c_str(), mask);
+	if (wd < 0) {
+		return false;
+	}
+	watchedDirectories[wd] = root;
+
+	std::error_code error{};
+	for (std::filesystem::directory_iterator it{ root, error }, end{}; !error && it != end; it.increment(error)) {
+		if (it->is_directory(error)) {
+			AddWatches(root + "/" + it->path().filename().string());
+		}
+	}
+	return true;
+}
+
+void FileWatcher::WatchLoop() {
+	Profiler::SetThreadName("File Watcher");
+
+	// poll wakes up periodically to check quit, stopping takes at most one timeout
+	constexpr int timeoutMs = 100;
+	alignas(inotify_event) char buffer[16 * 1024];
+	while (!quit) {
+		pollfd descriptor{ inotifyFd, POLLIN, 0 };
+		if (poll(&descriptor, 1, timeoutMs) <= 0) {
+			continue;
+		}
+		const ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+		for (ssize_t offset = 0; offset < length;) {
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+			offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+			auto it = watchedDirectories.find(event->wd);
+			if (it == watchedDirectories.end() || event->len == 0) {
+				continue;
+			}
+			const std::string path = it->second + "/" + event->name;
+			if (event->mask & IN_ISDIR) {
+				// files written into a new directory before its watch exists are missed, saving them again reloads
+				if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+					AddWatches(path);
+				}
+				continue;
+			}
+			Touch(path);
+		}
+	}
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+//
+// File Watcher
+// Reports files changed below a directory, for reloading assets and shaders while running
+// A background thread waits on the OS (inotify, ReadDirectoryChangesW) and collects paths;
+// Poll hands out the ones that stayed untouched for QuietTime, so an editor saving in
+// several steps (truncate, write, rename) triggers a single reload of the finished file
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class FileWatcher {
+public:
+	FileWatcher() = default;
+	~FileWatcher();
+
+	// watches every file below directory, including subdirectories created later
+	bool Start(const std::string& directory);
+	void Stop();
+	bool Running() const { return thread.joinable(); }
+
+	// appends each settled path once, as directory + '/' + relative path with forward slashes,
+	// does not allocate when nothing changed
+	void Poll(std::vector<std::string>& changed);
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+private:
+	using Clock = std::chrono::steady_clock;
+	static constexpr std::chrono::milliseconds QuietTime{ 100 };
+
+	std::string directory{};
+	std::thread thread{};
+	std::atomic<bool> quit{ false };
+
+	/* changed paths and when they were last touched, filled by the watcher thread */
+	std::mutex mutex{};
+	std::unordered_map<std::string, Clock::time_point> pending{};
+
+#ifdef _WIN32
+	void* hDirectory{ nullptr };
+	void* hStopEvent{ nullptr };
+#else
+	int inotifyFd{ -1 };
+	std::unordered_map<int, std::string> watchedDirectories{}; // by watch descriptor, watcher thread only after Start
+	bool AddWatches(const std::string& root);
+#endif
+
+	void WatchLoop();
+	void Touch(std::string path);
+};
\ No newline at end of file
@@ -0,0 +1,32 @@
+//
+// Mapped File
+// Read-only memory mapping of a whole file, the OS pages data in on first touch
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	bool Open(const std::string& path);
+	void Close();
+
+	bool IsOpen() const { return data != nullptr; }
+	const uint8_t* Data() const { return data; }
+	size_t Size() const { return size; }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+private:
+	const uint8_t* data{ nullptr };
+	size_t size{};
+#ifdef _WIN32
+	void* hFile{ nullptr };
+	void* hMapping{ nullptr };
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "MeshFile.h"
+#include "Util/Log.h"
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+	constexpr uint64_t AlignUp(uint64_t value) {
+		return (value + MeshFileAlignment - 1) & ~static_cast<uint64_t>(MeshFileAlignment - 1);
+	}
+
+	// blob lies inside the file and is aligned
+	bool BlobValid(uint64_t offset, uint64_t bytes, uint64_t fileSize) {
+		return offset % MeshFileAlignment == 0 && offset <= fileSize && bytes <= fileSize - offset;
+	}
+}
+
+bool MeshFile::Open(const std::string& path) {
+	Close();
+	if (!file.Open(path)) {
+		Log.error("[Mesh] could not map " + path);
+		return false;
+	}
+	if (file.Size() < sizeof(MeshFileHeader)) {
+		Log.error("[Mesh] " + path + " is too small to be a mesh file");
+		Close();
+		return false;
+	}
+
+	std::memcpy(&header, file.Data(), sizeof(MeshFileHeader));
+	if (header.magic != MeshFileMagic || header.version == 0 || header.version > MeshFileVersion) {
+		Log.error("[Mesh] " + path + " is not a version 1 to " + std::to_string(MeshFileVersion) + " mesh file");
+		Close();
+		return false;
+	}
+	// version 1 only ever wrote BasicVertex and 32 bit indices, so the same checks cover it
+	const bool packed = header.vertexStride == sizeof(PackedVertex);
+	if ((header.vertexStride != sizeof(BasicVertex) && !packed)
+		|| (header.indexSize != sizeof(uint32_t) && header.indexSize != sizeof(uint16_t)) || header.indexCount % 3 != 0
+		|| !BlobValid(header.vertexOffset, static_cast<uint64_t>(header.vertexCount) * header.vertexStride, file.Size())
+		|| !BlobValid(header.indexOffset, static_cast<uint64_t>(header.indexCount) * header.indexSize, file.Size())) {
+		Log.error("[Mesh] " + path + " has an invalid layout");
+		Close();
+		return false;
+	}
+
+	data.vertices = file.Data() + header.vertexOffset;
+	data.vertexCount = header.vertexCount;
+	data.vertexFormat = packed ? VertexFormat::Packed : VertexFormat::Basic;
+	data.indices = file.Data() + header.indexOffset;
+	data.indexCount = header.indexCount;
+	data.indexSize = header.indexSize;
+
+	if (header.version >= 3) {
+		// the table sits between the header and the vertices, every level is a whole number of triangles inside the index blob
+		MeshFileLodTable table{};
+		const uint64_t tableEnd = sizeof(MeshFileHeader) + sizeof(MeshFileLodTable);
+		bool valid = tableEnd <= header.vertexOffset && header.vertexOffset <= file.Size();
+		if (valid) {
+			std::memcpy(&table, file.Data() + sizeof(MeshFileHeader), sizeof(table));
+			valid = table.lodCount >= 1 && table.lodCount <= MaxMeshLods
+				&& tableEnd + static_cast<uint64_t>(table.lodCount) * sizeof(MeshLod) <= header.vertexOffset;
+		}
+		const MeshLod* lods = reinterpret_cast<const MeshLod*>(file.Data() + tableEnd);
+		for (uint32_t i = 0; valid && i < table.lodCount; ++i) {
+			valid = lods[i].firstIndex % 3 == 0 && lods[i].indexCount % 3 == 0 && lods[i].indexCount > 0
+				&& static_cast<uint64_t>(lods[i].firstIndex) + lods[i].indexCount <= header.indexCount;
+		}
+		if (!valid) {
+			Log.error("[Mesh] " + path + " has an invalid level of detail table");
+			Close();
+			return false;
+		}
+		data.lods = lods;
+		data.lodCount = table.lodCount;
+	}
+
+	// renderers index straight into the vertex blob, a bad index must not get that far
+	for (uint32_t i = 0; i < header.indexCount; ++i) {
+		if (data.Index(i) >= header.vertexCount) {
+			Log.error("[Mesh] " + path + " has an out of range index");
+			Close();
+			return false;
+		}
+	}
+	return true;
+}
+
+void MeshFile::Close() {
+	file.Close();
+	header = {};
+	data = {};
+}
+
+Aabb MeshFile::Bounds() const {
+	return {
+		{ header.boundsMin[0], header.boundsMin[1], header.boundsMin[2] },
+		{ header.boundsMax[0], header.boundsMax[1], header.boundsMax[2] } };
+}
+
+bool WriteMeshFile(const std::string& path, const MeshData& mesh) {
+	// from the stored positions, so quantized meshes are bounded by what is actually drawn
+	Aabb bounds{};
+	for (uint32_t i = 0; i < mesh.vertexCount; ++i) {
+		bounds.Grow(mesh.Position(i));
+	}
+	if (mesh.vertexCount == 0) {
+		bounds = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+	}
+
+	MeshFileHeader header{};
+	header.magic = MeshFileMagic;
+	header.version = MeshFileVersion;
+	header.vertexCount = mesh.vertexCount;
+	header.indexCount = mesh.indexCount;
+	header.vertexStride = VertexStride(mesh.vertexFormat);
+	header.indexSize = mesh.indexSize;
+	MeshFileLodTable table{};
+	table.lodCount = mesh.LodCount();
+	header.vertexOffset = AlignUp(sizeof(MeshFileHeader) + sizeof(MeshFileLodTable) + table.lodCount * sizeof(MeshLod));
+	header.indexOffset = AlignUp(header.vertexOffset + mesh.VertexBytes());
+	std::memcpy(header.boundsMin, &bounds.min, sizeof(header.boundsMin));
+	std::memcpy(header.boundsMax, &bounds.max, sizeof(header.boundsMax));
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out.is_open()) {
+		return false;
+	}
+
+	const char padding[MeshFileAlignment]{};
+	auto pad = [&](uint64_t offset) {
+		out.write(padding, static_cast<std::streamsize>(offset - static_cast<uint64_t>(out.tellp())));
+	};
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(&table), sizeof(table));
+	for (uint32_t i = 0; i < table.lodCount; ++i) {
+		const MeshLod lod = mesh.Lod(i);
+		out.write(reinterpret_cast<const char*>(&lod), sizeof(lod));
+	}
+	pad(header.vertexOffset);
+	out.write(static_cast<const char*>(mesh.vertices), static_cast<std::streamsize>(mesh.VertexBytes()));
+	pad(header.indexOffset);
+	out.write(static_cast<const char*>(mesh.indices), static_cast<std::streamsize>(mesh.IndexBytes()));
+	return out.good();
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+//
+// Mesh File
+// Binary mesh format, laid out so a memory mapped file can be handed to the
+// renderer as is: a fixed header, then the vertex and index blobs, each
+// aligned to MeshFileAlignment. All values are little endian.
+// Produced offline from OBJ with -convert, see ObjConverter
+// Version 2 adds quantized vertices and 16 bit indices, version 3 a level of detail
+// table right after the header (MeshFileLodTable, then lodCount MeshLods);
+// older files still load as a single level
+//
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include "MappedFile.h"
+#include "Util/Math/Vertices.h"
+#include "Util/Math/Aabb.h"
+
+inline constexpr uint32_t MeshFileMagic = 0x48534D42; // "BMSH"
+inline constexpr uint32_t MeshFileVersion = 3;
+inline constexpr uint32_t MeshFileAlignment = 16;
+
+struct MeshFileHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t vertexStride; // sizeof(BasicVertex) or sizeof(PackedVertex), which also selects the vertex format
+	uint32_t indexSize;    // 2 or 4
+	uint64_t vertexOffset; // from the start of the file
+	uint64_t indexOffset;
+	float boundsMin[3];    // object space box of all vertices
+	float boundsMax[3];
+};
+static_assert(sizeof(MeshFileHeader) == 64, "mesh file header layout is part of the format");
+
+struct MeshFileLodTable {
+	uint32_t lodCount; // 1 to MaxMeshLods
+	uint32_t reserved;
+};
+
+// a validated, mapped mesh file, the pointers stay valid until Close
+class MeshFile {
+public:
+	bool Open(const std::string& path);
+	void Close();
+
+	// points into the mapping
+	const MeshData& Data() const { return data; }
+	uint32_t VertexCount() const { return header.vertexCount; }
+	uint32_t IndexCount() const { return header.indexCount; }
+	uint32_t LodCount() const { return data.LodCount(); }
+	Aabb Bounds() const;
+private:
+	MappedFile file{};
+	MeshFileHeader header{};
+	MeshData data{};
+};
+
+// writes a mesh in the binary format, bounds are computed from the vertices
+bool WriteMeshFile(const std::string& path, const MeshData& mesh);
\ No newline at end of file
@@ -0,0 +1,317 @@
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "Util/Math/Aabb.h"
+#include "Util/Log.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace {
+	// scoring from Forsyth, "Linear-Speed Vertex Cache Optimisation"
+	constexpr uint32_t ModelCacheSize = 32;
+	constexpr float CacheDecayPower = 1.5f;
+	constexpr float LastTriangleScore = 0.75f;
+	constexpr float ValenceBoostScale = 2.0f;
+	constexpr float ValenceBoostPower = 0.5f;
+
+	// half float positions are kept while rounding moves no vertex further than this share
+	// of the largest LOD error, otherwise the full mesh would already look simplified
+	constexpr float MaxQuantizeErrorFraction = 0.01f;
+
+	// cachePosition -1 is not cached, a vertex without triangles left scores -1 so it is never picked
+	float VertexScore(int cachePosition, uint32_t remainingTriangles) {
+		if (remainingTriangles == 0) {
+			return -1.0f;
+		}
+		float score = 0.0f;
+		if (cachePosition >= 0) {
+			if (cachePosition < 3) {
+				// the triangle just drawn, fixed so it is not favoured for using the same vertices again
+				score = LastTriangleScore;
+			}
+			else {
+				const float scale = 1.0f / static_cast<float>(ModelCacheSize - 3);
+				score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, CacheDecayPower);
+			}
+		}
+		// vertices with few triangles left are finished first so they leave the cache for good
+		score += ValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -ValenceBoostPower);
+		return score;
+	}
+
+	std::string Fixed(float value) {
+		std::ostringstream oss{};
+		oss.precision(3);
+		oss << std::fixed << value;
+		return oss.str();
+	}
+}
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+	if (indexCount < 3 || vertexCount == 0) {
+		return {};
+	}
+	// a vertex is cached while fewer than cacheSize misses happened since it was last loaded
+	std::vector<uint32_t> loadedAt(vertexCount, 0);
+	uint32_t misses = 0;
+	uint32_t time = cacheSize + 1;
+	for (size_t i = 0; i < indexCount; ++i) {
+		const uint32_t v = indices[i];
+		if (time - loadedAt[v] > cacheSize) {
+			loadedAt[v] = time++;
+			++misses;
+		}
+	}
+	return {
+		static_cast<float>(misses) / static_cast<float>(indexCount / 3),
+		static_cast<float>(misses) / static_cast<float>(vertexCount) };
+}
+
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	// triangles of every vertex as one flat array, the live ones of v are
+	// adjacency[offsets[v], offsets[v] + remaining[v]), drawn ones are swapped past the end
+	std::vector<uint32_t> remaining(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; ++i) {
+		++remaining[indices[i]];
+	}
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; ++v) {
+		offsets[v + 1] = offsets[v] + remaining[v];
+	}
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+		for (size_t t = 0; t < triangleCount; ++t) {
+			for (size_t k = 0; k < 3; ++k) {
+				adjacency[next[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+			}
+		}
+	}
+
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t v = 0; v < vertexCount; ++v) {
+		vertexScores[v] = VertexScore(-1, remaining[v]);
+	}
+	std::vector<float> triangleScores(triangleCount);
+	for (size_t t = 0; t < triangleCount; ++t) {
+		triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+	}
+	std::vector<bool> drawn(triangleCount, false);
+
+	// changes a vertex's score and passes the difference on to its live triangles
+	auto rescore = [&](uint32_t v, int cachePosition) {
+		const float score = VertexScore(cachePosition, remaining[v]);
+		const float delta = score - vertexScores[v];
+		vertexScores[v] = score;
+		for (uint32_t i = offsets[v]; i < offsets[v] + remaining[v]; ++i) {
+			triangleScores[adjacency[i]] += delta;
+		}
+	};
+
+	// LRU model of the cache, with room for the three vertices pushed in per triangle
+	uint32_t cache[ModelCacheSize + 3]{};
+	uint32_t cacheCount = 0;
+	std::vector<uint32_t> output{};
+	output.reserve(triangleCount * 3);
+	size_t nextUndrawn = 0;
+	int64_t best = -1;
+
+	while (output.size() < triangleCount * 3) {
+		if (best < 0) {
+			// no cached vertex has triangles left, continue with the next one in input order
+			while (drawn[nextUndrawn]) {
+				++nextUndrawn;
+			}
+			best = static_cast<int64_t>(nextUndrawn);
+		}
+
+		const size_t t = static_cast<size_t>(best);
+		drawn[t] = true;
+		uint32_t newCache[ModelCacheSize + 3]{};
+		uint32_t newCount = 0;
+		for (size_t k = 0; k < 3; ++k) {
+			const uint32_t v = indices[t * 3 + k];
+			output.push_back(v);
+
+			uint32_t* live = &adjacency[offsets[v]];
+			for (uint32_t i = 0; i < remaining[v]; ++i) {
+				if (live[i] == t) {
+					std::swap(live[i], live[remaining[v] - 1]);
+					break;
+				}
+			}
+			--remaining[v];
+
+			if (std::find(newCache, newCache + newCount, v) == newCache + newCount) {
+				newCache[newCount++] = v;
+			}
+		}
+		const uint32_t triangleVertices = newCount;
+		for (uint32_t i = 0; i < cacheCount; ++i) {
+			if (std::find(newCache, newCache + triangleVertices, cache[i]) == newCache + triangleVertices) {
+				newCache[newCount++] = cache[i];
+			}
+		}
+
+		// vertices that fell out of the cache lose their cache bonus
+		for (uint32_t i = ModelCacheSize; i < newCount; ++i) {
+			rescore(newCache[i], -1);
+		}
+		cacheCount = std::min(newCount, ModelCacheSize);
+		std::copy(newCache, newCache + cacheCount, cache);
+
+		best = -1;
+		float bestScore = -1.0f;
+		for (uint32_t i = 0; i < cacheCount; ++i) {
+			rescore(cache[i], static_cast<int>(i));
+		}
+		for (uint32_t i = 0; i < cacheCount; ++i) {
+			const uint32_t v = cache[i];
+			for (uint32_t j = offsets[v]; j < offsets[v] + remaining[v]; ++j) {
+				const uint32_t candidate = adjacency[j];
+				if (triangleScores[candidate] > bestScore) {
+					bestScore = triangleScores[candidate];
+					best = candidate;
+				}
+			}
+		}
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void OptimizeVertexFetch(std::vector<BasicVertex>& vertices, uint32_t* indices, size_t indexCount) {
+	std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+	std::vector<BasicVertex> ordered{};
+	ordered.reserve(vertices.size());
+	for (size_t i = 0; i < indexCount; ++i) {
+		uint32_t& index = indices[i];
+		if (remap[index] == UINT32_MAX) {
+			remap[index] = static_cast<uint32_t>(ordered.size());
+			ordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+	vertices.swap(ordered);
+}
+
+MeshData OptimizedMesh::Data() const {
+	MeshData data{};
+	if (!packedVertices.empty()) {
+		data.vertices = packedVertices.data();
+		data.vertexCount = static_cast<uint32_t>(packedVertices.size());
+		data.vertexFormat = VertexFormat::Packed;
+	}
+	else {
+		data.vertices = basicVertices.data();
+		data.vertexCount = static_cast<uint32_t>(basicVertices.size());
+		data.vertexFormat = VertexFormat::Basic;
+	}
+	if (!indices16.empty()) {
+		data.indices = indices16.data();
+		data.indexCount = static_cast<uint32_t>(indices16.size());
+		data.indexSize = sizeof(uint16_t);
+	}
+	else {
+		data.indices = indices32.data();
+		data.indexCount = static_cast<uint32_t>(indices32.size());
+		data.indexSize = sizeof(uint32_t);
+	}
+	data.lods = lods.data();
+	data.lodCount = static_cast<uint32_t>(lods.size());
+	return data;
+}
+
+OptimizedMesh OptimizeMesh(std::vector<BasicVertex> vertices, std::vector<uint32_t> indices, const MeshOptimizeOptions& options) {
+	const size_t bytesBefore = vertices.size() * sizeof(BasicVertex) + indices.size() * sizeof(uint32_t);
+	const VertexCacheStats before = AnalyzeVertexCache(indices.data(), indices.size(), vertices.size());
+
+	// every level is simplified from the full mesh, so errors do not add up along the chain
+	Aabb bounds{};
+	for (const BasicVertex& vertex : vertices) {
+		bounds.Grow(vertex.Pos);
+	}
+	const float radius = vertices.empty() ? 0.0f : Length(bounds.Extents());
+	std::vector<std::vector<uint32_t>> levels{ indices };
+	std::vector<float> errors{ 0.0f };
+	while (levels.size() < std::min(options.maxLods, MaxMeshLods)) {
+		const size_t previous = levels.back().size();
+		const size_t target = (indices.size() >> levels.size()) / 3 * 3;
+		float error{};
+		std::vector<uint32_t> level = SimplifyMesh(vertices, indices, target, options.maxLodError * radius, error);
+		if (level.empty() || level.size() * 5 > previous * 4) {
+			break;
+		}
+		levels.push_back(std::move(level));
+		errors.push_back(error);
+	}
+
+	// levels back to back in one index buffer; fetch order follows the full mesh, which
+	// references every vertex the coarser levels use
+	OptimizedMesh mesh{};
+	indices.clear();
+	for (size_t i = 0; i < levels.size(); ++i) {
+		OptimizeVertexCache(levels[i].data(), levels[i].size(), vertices.size());
+		mesh.lods.push_back({ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(levels[i].size()), errors[i] });
+		indices.insert(indices.end(), levels[i].begin(), levels[i].end());
+	}
+	OptimizeVertexFetch(vertices, indices.data(), indices.size());
+	const VertexCacheStats after = AnalyzeVertexCache(indices.data(), mesh.lods[0].indexCount, vertices.size());
+
+	if (options.quantize) {
+		// half precision is relative, a mesh far from its origin rounds as coarsely as a large one
+		const Vec3 farthest = Max(Vec3{ std::fabs(bounds.min.x), std::fabs(bounds.min.y), std::fabs(bounds.min.z) },
+			Vec3{ std::fabs(bounds.max.x), std::fabs(bounds.max.y), std::fabs(bounds.max.z) });
+		const float maxCoord = std::max({ farthest.x, farthest.y, farthest.z });
+		if (maxCoord > HalfMax) {
+			Log.warning("[Optimize] coordinates up to " + Fixed(maxCoord) + " exceed the half float range, keeping 32 bit positions");
+		}
+		else {
+			float quantizeError{ 0.0f };
+			mesh.packedVertices.reserve(vertices.size());
+			for (const BasicVertex& vertex : vertices) {
+				const PackedVertex packed = PackVertex(vertex);
+				const Vec3 rounded{ HalfToFloat(packed.Pos[0]), HalfToFloat(packed.Pos[1]), HalfToFloat(packed.Pos[2]) };
+				quantizeError = std::max(quantizeError, Length(rounded - vertex.Pos));
+				mesh.packedVertices.push_back(packed);
+			}
+			if (quantizeError > MaxQuantizeErrorFraction * options.maxLodError * radius) {
+				Log.warning("[Optimize] half float positions would move vertices by up to " + Fixed(quantizeError)
+					+ ", keeping 32 bit positions");
+				mesh.packedVertices.clear();
+			}
+			else {
+				// what is drawn deviates from the source by the rounding on top of the simplification
+				for (MeshLod& lod : mesh.lods) {
+					lod.error += quantizeError;
+				}
+			}
+		}
+	}
+	if (mesh.packedVertices.empty()) {
+		mesh.basicVertices = std::move(vertices);
+	}
+	// unreferenced vertices are gone, so the count is exactly what the indices need to address
+	if (mesh.packedVertices.size() + mesh.basicVertices.size() <= 0x10000) {
+		mesh.indices16.assign(indices.begin(), indices.end());
+	}
+	else {
+		mesh.indices32 = std::move(indices);
+	}
+
+	for (size_t i = 1; i < mesh.lods.size(); ++i) {
+		Log.info("[Optimize] LOD " + std::to_string(i) + ": " + std::to_string(mesh.lods[i].indexCount / 3) + " triangles, error "
+			+ Fixed(mesh.lods[i].error) + " (" + Fixed(radius > 0.0f ? 100.0f * mesh.lods[i].error / radius : 0.0f) + "% of the bounding radius)");
+	}
+	const MeshData data = mesh.Data();
+	Log.info("[Optimize] ACMR " + Fixed(before.acmr) + " -> " + Fixed(after.acmr) + ", ATVR " + Fixed(before.atvr) + " -> " + Fixed(after.atvr)
+		+ ", bytes per vertex " + std::to_string(sizeof(BasicVertex)) + " -> " + std::to_string(VertexStride(data.vertexFormat))
+		+ ", per index " + std::to_string(sizeof(uint32_t)) + " -> " + std::to_string(data.indexSize)
+		+ ", total " + std::to_string(bytesBefore) + " -> " + std::to_string(data.VertexBytes() + data.IndexBytes()) + " bytes");
+	return mesh;
+}
\ No newline at end of file
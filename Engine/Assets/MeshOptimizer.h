@@ -0,0 +1,53 @@
+//
+// Mesh Optimizer
+// Offline passes run by the converter before a mesh is written: a level of
+// detail chain (see MeshSimplifier), triangle order for the post-transform
+// vertex cache (Forsyth's linear-speed algorithm), vertex order for fetch
+// locality and attribute quantization
+// Cache efficiency is measured on a FIFO cache, see AnalyzeVertexCache
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Util/Math/Vertices.h"
+
+struct VertexCacheStats {
+	float acmr{}; // average cache miss ratio, transformed vertices per triangle: 0.5 is ideal on a regular grid, 3 is no reuse
+	float atvr{}; // average transform to vertex ratio, 1 means every vertex is transformed once
+};
+
+// simulates a FIFO post-transform cache, 16 entries is a conservative stand-in for current GPUs
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16);
+
+// reorders the triangles in place so consecutive ones share vertices, winding is kept
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+// reorders vertices by first use in the index buffer and remaps the indices, unreferenced
+// vertices are dropped; run after OptimizeVertexCache
+void OptimizeVertexFetch(std::vector<BasicVertex>& vertices, uint32_t* indices, size_t indexCount);
+
+// a mesh ready to be written, in the smallest formats the options allow
+struct OptimizedMesh {
+	std::vector<BasicVertex> basicVertices{};
+	std::vector<PackedVertex> packedVertices{};
+	std::vector<uint32_t> indices32{};
+	std::vector<uint16_t> indices16{};
+	std::vector<MeshLod> lods{}; // ranges of the indices, finest first
+
+	MeshData Data() const;
+};
+
+struct MeshOptimizeOptions {
+	// half float positions and UNORM8 colors, positions stay 32 bit when they do not fit a half
+	// or rounding them would move vertices by more than a hundredth of maxLodError times the radius
+	bool quantize{ true };
+	// every level halves the triangles of the one before, levels that would deviate more than
+	// maxLodError times the bounding radius or save less than a fifth are not generated
+	uint32_t maxLods{ 4 };
+	float maxLodError{ 0.25f };
+};
+
+// runs every pass, logs the levels, ACMR/ATVR of the full mesh and bytes per vertex and index before and after
+OptimizedMesh OptimizeMesh(std::vector<BasicVertex> vertices, std::vector<uint32_t> indices, const MeshOptimizeOptions& options);
\ No newline at end of file
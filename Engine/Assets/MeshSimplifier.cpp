@@ -0,0 +1,267 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+	// borders only have planes on one side, weighted up so open edges keep their outline
+	constexpr double BorderWeight = 10.0;
+
+	// collapses turning a neighbouring triangle further than acos(0.25) (about 75 degrees) are
+	// rejected, which also keeps triangles from being squashed into slivers
+	constexpr float MinNormalCos = 0.25f;
+
+	// symmetric 4x4 matrix of the plane equations a vertex should stay on, plus their total
+	// weight so the error is an average squared distance instead of growing with the area
+	struct Quadric {
+		double a2{}, ab{}, ac{}, ad{};
+		double b2{}, bc{}, bd{};
+		double c2{}, cd{};
+		double d2{};
+		double weight{};
+
+		static Quadric FromPlane(double a, double b, double c, double d, double weight) {
+			Quadric q{};
+			q.a2 = a * a * weight; q.ab = a * b * weight; q.ac = a * c * weight; q.ad = a * d * weight;
+			q.b2 = b * b * weight; q.bc = b * c * weight; q.bd = b * d * weight;
+			q.c2 = c * c * weight; q.cd = c * d * weight;
+			q.d2 = d * d * weight;
+			q.weight = weight;
+			return q;
+		}
+
+		Quadric& operator+=(const Quadric& o) {
+			a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad;
+			b2 += o.b2; bc += o.bc; bd += o.bd;
+			c2 += o.c2; cd += o.cd;
+			d2 += o.d2;
+			weight += o.weight;
+			return *this;
+		}
+
+		// weighted mean squared distance of p to the planes
+		double Error(const Vec3& p) const {
+			const double x = p.x, y = p.y, z = p.z;
+			const double sum = a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+				+ b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+				+ c2 * z * z + 2.0 * cd * z
+				+ d2;
+			return weight > 0.0 ? std::max(sum, 0.0) / weight : 0.0;
+		}
+	};
+
+	Vec3 TriangleNormal(const Vec3& p0, const Vec3& p1, const Vec3& p2) {
+		return Cross(p1 - p0, p2 - p0);
+	}
+
+	uint64_t EdgeKey(uint32_t a, uint32_t b) {
+		return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+	}
+
+	struct Collapse {
+		uint32_t from;
+		uint32_t to;
+		double cost;
+	};
+}
+
+std::vector<uint32_t> SimplifyMesh(const std::vector<BasicVertex>& vertices, const std::vector<uint32_t>& indices,
+	size_t targetIndexCount, float maxError, float& error) {
+	const size_t vertexCount = vertices.size();
+	std::vector<uint32_t> result(indices.begin(), indices.end() - indices.size() % 3);
+	error = 0.0f;
+	if (result.size() <= targetIndexCount) {
+		return result;
+	}
+
+	/* seams: vertices sharing a position with another vertex are locked */
+	std::vector<uint8_t> locked(vertexCount, 0);
+	{
+		std::vector<uint32_t> order(vertexCount);
+		for (uint32_t v = 0; v < vertexCount; ++v) {
+			order[v] = v;
+		}
+		auto less = [&](uint32_t a, uint32_t b) {
+			const Vec3& p = vertices[a].Pos;
+			const Vec3& q = vertices[b].Pos;
+			return p.x != q.x ? p.x < q.x : (p.y != q.y ? p.y < q.y : p.z < q.z);
+		};
+		std::sort(order.begin(), order.end(), less);
+		for (size_t i = 1; i < order.size(); ++i) {
+			if (!less(order[i - 1], order[i])) {
+				locked[order[i - 1]] = 1;
+				locked[order[i]] = 1;
+			}
+		}
+	}
+
+	/* quadrics from the original triangles and borders */
+	std::vector<Quadric> quadrics(vertexCount);
+	std::unordered_map<uint64_t, uint32_t> edgeUse{};
+	for (size_t i = 0; i < result.size(); i += 3) {
+		for (size_t k = 0; k < 3; ++k) {
+			++edgeUse[EdgeKey(result[i + k], result[i + (k + 1) % 3])];
+		}
+	}
+	for (size_t i = 0; i < result.size(); i += 3) {
+		const uint32_t tri[3] = { result[i], result[i + 1], result[i + 2] };
+		const Vec3& p0 = vertices[tri[0]].Pos;
+		Vec3 normal = TriangleNormal(p0, vertices[tri[1]].Pos, vertices[tri[2]].Pos);
+		const float length = Length(normal);
+		if (length <= 0.0f) {
+			continue;
+		}
+		const double area = 0.5 * length;
+		normal = normal * (1.0f / length);
+		const Quadric plane = Quadric::FromPlane(normal.x, normal.y, normal.z, -Dot(normal, p0), area);
+		for (uint32_t v : tri) {
+			quadrics[v] += plane;
+		}
+
+		for (size_t k = 0; k < 3; ++k) {
+			const uint32_t a = tri[k];
+			const uint32_t b = tri[(k + 1) % 3];
+			if (edgeUse[EdgeKey(a, b)] != 1) {
+				continue;
+			}
+			// plane through the border edge, perpendicular to the triangle
+			const Vec3 edge = vertices[b].Pos - vertices[a].Pos;
+			Vec3 side = Cross(edge, normal);
+			const float sideLength = Length(side);
+			if (sideLength <= 0.0f) {
+				continue;
+			}
+			side = side * (1.0f / sideLength);
+			const Quadric border = Quadric::FromPlane(side.x, side.y, side.z, -Dot(side, vertices[a].Pos), Dot(edge, edge) * BorderWeight);
+			quadrics[a] += border;
+			quadrics[b] += border;
+		}
+	}
+
+	const double maxCost = static_cast<double>(maxError) * static_cast<double>(maxError);
+	double worstCost = 0.0;
+	std::vector<uint32_t> remap(vertexCount);
+	std::vector<uint8_t> touched(vertexCount);
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	std::vector<uint32_t> adjacency{};
+	std::vector<Collapse> collapses{};
+
+	// every pass collapses an independent set of edges, cheapest first, then rebuilds the triangle list
+	while (result.size() > targetIndexCount) {
+		const size_t triangleCount = result.size() / 3;
+
+		// triangles around every vertex
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (uint32_t v : result) {
+			++adjacencyOffsets[v + 1];
+		}
+		for (size_t v = 0; v < vertexCount; ++v) {
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+		}
+		adjacency.resize(result.size());
+		{
+			std::vector<uint32_t> next(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < result.size(); ++i) {
+				adjacency[next[result[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		// the cheaper direction of every edge
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (size_t k = 0; k < 3; ++k) {
+				const uint32_t a = result[i + k];
+				const uint32_t b = result[i + (k + 1) % 3];
+				if (a > b && edgeUse[EdgeKey(a, b)] >= 2) {
+					continue; // interior edges are seen from both triangles, keep one
+				}
+				Quadric q = quadrics[a];
+				q += quadrics[b];
+				const double toB = locked[a] ? HUGE_VAL : q.Error(vertices[b].Pos);
+				const double toA = locked[b] ? HUGE_VAL : q.Error(vertices[a].Pos);
+				if (toB == HUGE_VAL && toA == HUGE_VAL) {
+					continue;
+				}
+				collapses.push_back(toB <= toA ? Collapse{ a, b, toB } : Collapse{ b, a, toA });
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+		for (uint32_t v = 0; v < vertexCount; ++v) {
+			remap[v] = v;
+		}
+		std::fill(touched.begin(), touched.end(), 0);
+		size_t trianglesLeft = triangleCount;
+		size_t collapsed = 0;
+		for (const Collapse& collapse : collapses) {
+			if (trianglesLeft * 3 <= targetIndexCount || collapse.cost > maxCost) {
+				break;
+			}
+			const uint32_t u = collapse.from;
+			const uint32_t v = collapse.to;
+			if (touched[u] || touched[v]) {
+				continue;
+			}
+
+			// moving u onto v must not turn any of u's other triangles over or collapse it to a line
+			bool flips = false;
+			uint32_t removed = 0;
+			for (uint32_t j = adjacencyOffsets[u]; j < adjacencyOffsets[u + 1] && !flips; ++j) {
+				const uint32_t* tri = &result[adjacency[j] * 3];
+				if (tri[0] == v || tri[1] == v || tri[2] == v) {
+					++removed;
+					continue;
+				}
+				const Vec3 before = TriangleNormal(vertices[tri[0]].Pos, vertices[tri[1]].Pos, vertices[tri[2]].Pos);
+				const Vec3& p0 = vertices[tri[0] == u ? v : tri[0]].Pos;
+				const Vec3& p1 = vertices[tri[1] == u ? v : tri[1]].Pos;
+				const Vec3& p2 = vertices[tri[2] == u ? v : tri[2]].Pos;
+				const Vec3 after = TriangleNormal(p0, p1, p2);
+				flips = Dot(before, after) <= MinNormalCos * Length(before) * Length(after);
+			}
+			if (flips) {
+				continue;
+			}
+
+			// lock the whole neighbourhood for this pass, so the flip test above stays valid
+			for (uint32_t j = adjacencyOffsets[u]; j < adjacencyOffsets[u + 1]; ++j) {
+				const uint32_t* tri = &result[adjacency[j] * 3];
+				touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+			}
+			remap[u] = v;
+			quadrics[v] += quadrics[u];
+			worstCost = std::max(worstCost, collapse.cost);
+			trianglesLeft -= removed;
+			++collapsed;
+		}
+		if (collapsed == 0) {
+			break;
+		}
+
+		// apply the collapses and drop the triangles that became degenerate
+		size_t write = 0;
+		for (size_t i = 0; i < result.size(); i += 3) {
+			const uint32_t a = remap[result[i]];
+			const uint32_t b = remap[result[i + 1]];
+			const uint32_t c = remap[result[i + 2]];
+			if (a == b || b == c || a == c) {
+				continue;
+			}
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+
+		// edge use changed around every collapse, recount it for the next pass
+		edgeUse.clear();
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (size_t k = 0; k < 3; ++k) {
+				++edgeUse[EdgeKey(result[i + k], result[i + (k + 1) % 3])];
+			}
+		}
+	}
+
+	error = static_cast<float>(std::sqrt(worstCost));
+	return result;
+}
\ No newline at end of file
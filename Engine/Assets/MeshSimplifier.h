@@ -0,0 +1,22 @@
+//
+// Mesh Simplifier
+// Quadric error metric simplification (Garland and Heckbert) by half-edge
+// collapses: a vertex is only ever merged into one of its neighbours, so a
+// simplified mesh indexes the vertices of the full one and every level of
+// detail can share one vertex buffer
+// Border edges are held in place by extra planes through them, vertices that
+// share a position with another one (attribute seams) never move and collapses
+// that would flip a triangle are rejected
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Util/Math/Vertices.h"
+
+// collapses edges cheapest first until at most targetIndexCount indices are left or
+// the next collapse would deviate more than maxError; error receives the object space
+// deviation estimate of the result (root mean square distance to the original planes)
+std::vector<uint32_t> SimplifyMesh(const std::vector<BasicVertex>& vertices, const std::vector<uint32_t>& indices,
+	size_t targetIndexCount, float maxError, float& error);
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "ObjConverter.h"
+#include "MeshFile.h"
+#include "Util/Log.h"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace {
+	// 1 based, negative counts back from the latest vertex, 0 is invalid
+	bool ResolveIndex(long index, size_t vertexCount, uint32_t& out) {
+		if (index > 0 && static_cast<size_t>(index) <= vertexCount) {
+			out = static_cast<uint32_t>(index - 1);
+			return true;
+		}
+		if (index < 0 && static_cast<size_t>(-index) <= vertexCount) {
+			out = static_cast<uint32_t>(vertexCount + index);
+			return true;
+		}
+		return false;
+	}
+}
+
+bool ConvertObjToMesh(const std::string& objPath, const std::string& meshPath, const MeshOptimizeOptions& options) {
+	std::ifstream in(objPath);
+	if (!in.is_open()) {
+		Log.error("[Convert] could not open " + objPath);
+		return false;
+	}
+
+	std::vector<BasicVertex> vertices{};
+	std::vector<uint32_t> indices{};
+	std::vector<uint32_t> face{};
+
+	std::string line{};
+	size_t lineNumber{ 0 };
+	while (std::getline(in, line)) {
+		++lineNumber;
+		std::istringstream tokens(line);
+		std::string keyword{};
+		tokens >> keyword;
+
+		if (keyword == "v") {
+			BasicVertex vertex{ { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } };
+			tokens >> vertex.Pos.x >> vertex.Pos.y >> vertex.Pos.z;
+			if (tokens.fail()) {
+				Log.error("[Convert] " + objPath + ":" + std::to_string(lineNumber) + " bad vertex");
+				return false;
+			}
+			vertex.Pos.z = -vertex.Pos.z;
+
+			float r{}, g{}, b{};
+			if (tokens >> r >> g >> b) {
+				vertex.Color = { r, g, b, 1.0f };
+			}
+			vertices.push_back(vertex);
+		}
+		else if (keyword == "f") {
+			// each corner is v, v/vt, v/vt/vn or v//vn, only v is used
+			face.clear();
+			std::string corner{};
+			while (tokens >> corner) {
+				uint32_t index{};
+				if (!ResolveIndex(std::strtol(corner.c_str(), nullptr, 10), vertices.size(), index)) {
+					Log.error("[Convert] " + objPath + ":" + std::to_string(lineNumber) + " bad face index");
+					return false;
+				}
+				face.push_back(index);
+			}
+
+			// mirroring z keeps the on-screen winding, so reverse it to turn counter-clockwise into clockwise
+			for (size_t i = 2; i < face.size(); ++i) {
+				indices.push_back(face[0]);
+				indices.push_back(face[i]);
+				indices.push_back(face[i - 1]);
+			}
+		}
+	}
+
+	if (vertices.empty() || indices.empty()) {
+		Log.error("[Convert] " + objPath + " has no triangles");
+		return false;
+	}
+	const OptimizedMesh mesh = OptimizeMesh(std::move(vertices), std::move(indices), options);
+	const MeshData data = mesh.Data();
+	if (!WriteMeshFile(meshPath, data)) {
+		Log.error("[Convert] could not write " + meshPath);
+		return false;
+	}
+
+	Log.info("[Convert] " + objPath + " -> " + meshPath + ": " + std::to_string(data.vertexCount) + " vertices, "
+		+ std::to_string(data.indexCount / 3) + " triangles");
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+//
+// OBJ Converter
+// Offline conversion of Wavefront OBJ into the binary mesh format
+// Supports positions with the common "v x y z r g b" vertex color extension and
+// polygonal faces (triangulated as fans), other statements are ignored
+// OBJ is right handed with counter-clockwise front faces, z is mirrored and the
+// winding reversed so the result is left handed with clockwise front faces like the rest of the engine
+// The mesh goes through OptimizeMesh before it is written
+//
+
+#pragma once
+#include <string>
+#include "MeshOptimizer.h"
+
+bool ConvertObjToMesh(const std::string& objPath, const std::string& meshPath, const MeshOptimizeOptions& options = {});
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "Camera.h"
+
+void Camera::SetView(const Vec3& position, const Vec3& direction) {
+	if (position != mPosition || direction != mDirection) {
+		mPosition = position;
+		mDirection = direction;
+		mViewDirty = true;
+	}
+}
+
+void Camera::SetLens(float fovY, float nearZ, float farZ) {
+	if (fovY != mFovY || nearZ != mNearZ || farZ != mFarZ) {
+		mFovY = fovY;
+		mNearZ = nearZ;
+		mFarZ = farZ;
+		mProjDirty = true;
+	}
+}
+
+void Camera::SetAspectRatio(float aspectRatio) {
+	if (aspectRatio != mAspectRatio) {
+		mAspectRatio = aspectRatio;
+		mProjDirty = true;
+	}
+}
+
+void Camera::Update() {
+	if (!mViewDirty && !mProjDirty) {
+		return;
+	}
+
+	if (mViewDirty) {
+		constexpr Vec3 up{ 0.0f, 1.0f, 0.0f };
+		mView = Mat4::LookAtLH(mPosition, mPosition + mDirection, up);
+	}
+	if (mProjDirty) {
+		mProj = Mat4::PerspectiveFovLH(mFovY, mAspectRatio, mNearZ, mFarZ);
+	}
+
+	mViewProj = mView * mProj;
+	mFrustum = Frustum::FromViewProj(mViewProj);
+	mViewDirty = false;
+	mProjDirty = false;
+	++mVersion;
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+//
+// Camera
+// Owns view, projection and view-projection matrices
+// They are only rebuilt in Update() when the view, lens or aspect ratio actually changed
+//
+
+#pragma once
+#include <cstdint>
+#include "Util/Math/Vectors.h"
+#include "Util/Math/Mat4.h"
+#include "Util/Math/Frustum.h"
+#include "Util/Math/MathCommon.h"
+
+class Camera {
+public:
+	Camera() = default;
+
+	void SetView(const Vec3& position, const Vec3& direction);
+	void SetLens(float fovY, float nearZ, float farZ);
+	void SetAspectRatio(float aspectRatio);
+
+	// rebuilds whatever is out of date, call once per frame before reading the matrices
+	void Update();
+
+	const Mat4& View() const { return mView; }
+	const Mat4& Proj() const { return mProj; }
+	const Mat4& ViewProj() const { return mViewProj; }
+	// world space planes, rebuilt together with ViewProj
+	const Frustum& GetFrustum() const { return mFrustum; }
+
+	const Vec3& Position() const { return mPosition; }
+	const Vec3& Direction() const { return mDirection; }
+	float FovY() const { return mFovY; }
+	float AspectRatio() const { return mAspectRatio; }
+	float NearZ() const { return mNearZ; }
+	float FarZ() const { return mFarZ; }
+
+	// incremented every time ViewProj changes
+	uint32_t Version() const { return mVersion; }
+private:
+	Vec3 mPosition{ 0.0f, 0.0f, 0.0f };
+	Vec3 mDirection{ 0.0f, 0.0f, 1.0f };
+	float mFovY{ Math::PiDiv4 };
+	float mAspectRatio{ 16.0f / 9.0f };
+	float mNearZ{ 0.1f };
+	float mFarZ{ 1000.0f };
+
+	Mat4 mView{ Mat4::Identity() };
+	Mat4 mProj{ Mat4::Identity() };
+	Mat4 mViewProj{ Mat4::Identity() };
+	Frustum mFrustum{};
+
+	bool mViewDirty{ true };
+	bool mProjDirty{ true };
+	uint32_t mVersion{};
+};
\ No newline at end of file
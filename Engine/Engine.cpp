@@ -1,7 +1,19 @@
 #include "Engine.h"
 #include "Util/Log.h"
+#include "Util/Stats.h"
+#include "Renderer/CubeGeometry.h"
 #include <sstream>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+Engine::Engine(const RendererOptions& options)
+    : opts{ options }
+{
+}
 
 Engine::~Engine()
 {
@@ -11,12 +23,137 @@ bool Engine::Initialize() {
     InitializeLogging(); // do not log before this
     Log.info("Starting engine...");
 
+    Profiler::SetThreadName("Main");
+    JobSystem::Get().Initialize();
+    Log.info("Job system running on " + std::to_string(JobSystem::Get().ThreadCount()) + " threads");
+
+    if (opts.headless) {
+        Log.info("Running headless, no window will be created");
+    }
+    else if (!InitializeWindow()) {
+        return false;
+    }
+
+    if (!InitializeRenderer()) {
+        Log.error("Renderer initialization failed");
+        if (window) {
+            glfwDestroyWindow(window);
+            glfwTerminate();
+        }
+        return false;
+    }
+
+    pController = std::make_unique<PlayerController>();
+    mPrevPlayerPos = pController->m_Pos;
+    InitializeAssets();
+    InitializeInput();
+    InitializeScene();
+    if (opts.hotReload) {
+        fileWatcher.Start("assets");
+    }
+
+    if (opts.traceFrames > 0) {
+        Profiler::Get().CaptureFrames(opts.traceFrames, "trace.json");
+    }
+
+    renderThread.Start(pRenderer.get(), opts.renderThread);
+    return true;
+}
+
+void Engine::Run() {
+    Log.info("Running engine");
+
+    if (opts.headless) {
+        RunHeadless();
+        return;
+    }
+
+    mPacer.SetTargetFps(opts.fpsLimit);
+    if (opts.fpsLimit > 0.0f) {
+        Log.info("Frame rate capped at " + std::to_string(opts.fpsLimit) + " while vSync is off");
+    }
+
+    mTimer.Reset();
+    while (!glfwWindowShouldClose(window)) {
+        Profiler::Get().BeginFrame();
+        FrameArena::Get().Reset();
+        mTimer.Tick();
+        CalculateFPS();
+        {
+            PROFILE_ZONE("Poll Events");
+            glfwPollEvents();
+        }
+
+        Update(mTimer.DeltaTime());
+        Render();
+        if (!opts.vSync) {
+            // with vSync Present already blocks, pacing on top of it would only add latency
+            mPacer.Wait();
+        }
+        Profiler::Get().EndFrame();
+    }
+}
+
+void Engine::Shutdown() {
+    Log.info("Shutting down engine...");
+
+    Log.info("Stopping render thread...");
+    renderThread.Stop();
+
+    Log.info("Stopping file watcher...");
+    fileWatcher.Stop();
+
+    Log.info("Shutting down asset streaming...");
+    cubeAsset = {};
+    assets.Shutdown();
+
+    Log.info("Shutting down renderer...");
+    pRenderer->Shutdown();
+
+    Log.info("Shutting down job system...");
+    JobSystem::Get().Shutdown();
+
+    /* GLFW AND WINDOW DESTRUCTION */
+    if (window) {
+        Log.info("Destroying window and GLFW");
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+
+    // drain the log queue, anything logged after this is written synchronously
+    Logger::Shutdown();
+}
+
+/* Private Functions */
+void Engine::InitializeLogging() {
+#if defined(_WIN32) && defined(_DEBUG)
+    AllocConsole();
+    SetConsoleTitle(TEXT("Debug Console"));
+    freopen_s(reinterpret_cast<FILE**>(stdout), "CONOUT$", "w", stdout);
+    freopen_s(reinterpret_cast<FILE**>(stdin), "CONIN$", "r", stdin);
+    freopen_s(reinterpret_cast<FILE**>(stderr), "CONOUT$", "w", stderr);
+#endif
+    Logger::Init();
+    Log.info("----- Logging Started -----");
+}
+
+bool Engine::InitializeWindow() {
     /* GLFW AND WINDOW CREATION */
+#ifndef _WIN32
+    // a build without X11 and Wayland only has GLFW's null platform, which is never picked unasked
+    if (!glfwPlatformSupported(GLFW_PLATFORM_X11) && !glfwPlatformSupported(GLFW_PLATFORM_WAYLAND))
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
     if (!glfwInit())
+    {
+        Log.error("GLFW initialization failed");
         return false;
+    }
     Log.info("GLFW initialized");
 
-    window = glfwCreateWindow(1280, 720, "the game", nullptr, nullptr);
+    // the renderers present on their own, an OpenGL context would only be in the way (and the null platform has none)
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    window = glfwCreateWindow(opts.width, opts.height, "the game", nullptr, nullptr);
     if (!window)
     {
         Log.error("Failed to create window, terminating GLFW");
@@ -33,91 +170,255 @@ bool Engine::Initialize() {
         glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
 
     Log.info("GLFW window created");
+#ifdef _WIN32
     this->hWnd = glfwGetWin32Window(window);
     if (!hWnd) { Log.error("hWnd is invalid"); }
+#endif
+    return true;
+}
 
+bool Engine::InitializeRenderer() {
     /* RENDERER INITIALIZATION */
-    pRenderer = std::make_unique<D3DRenderer>();
-    if (!pRenderer->Initialize(hWnd, &opts)) {
-        Log.error("Renderer initialization failed");
-        glfwDestroyWindow(window);
-        glfwTerminate();
-        return false;
+    if (opts.headless && opts.backend == RendererBackend::Direct3D11) {
+        // nothing to present to, keep the CPU side of the frame only
+        opts.backend = RendererBackend::Null;
     }
+    viewportHeight = opts.height;
 
-    pController = std::make_unique<PlayerController>();
+#ifdef _WIN32
+    if (opts.backend == RendererBackend::Direct3D11) {
+        pRenderer = std::make_unique<D3DRenderer>();
+        if (pRenderer->Initialize(hWnd, &opts)) {
+            return true;
+        }
+        Log.warning("Direct3D 11 initialization failed, falling back to the software renderer");
+        pRenderer->Shutdown();
+    }
+#endif
+    if (opts.backend == RendererBackend::Null) {
+        pRenderer = std::make_unique<NullRenderer>();
+    }
+    else {
+        opts.backend = RendererBackend::Software;
+        pRenderer = std::make_unique<SoftwareRenderer>();
+    }
+    return pRenderer->Initialize(hWnd, &opts);
+}
 
-    return true;
+void Engine::InitializeAssets() {
+    // every mesh shows the built-in cube until its file has streamed in
+    assets.Initialize(pRenderer.get(), CubeVertices, static_cast<uint32_t>(std::size(CubeVertices)),
+        CubeIndices, static_cast<uint32_t>(std::size(CubeIndices)));
+    assets.SetMeshLoadedCallback([this](MeshHandle mesh, const Aabb& bounds, const MeshData& data) {
+        scene.SetMeshBounds(mesh, bounds.Center(), bounds.Extents());
+        scene.SetMeshLods(mesh, data.lods, data.lodCount);
+    });
 }
 
-void Engine::Run() {
-    Log.info("Running engine");
+void Engine::InitializeInput() {
+    input.Bind(GLFW_KEY_W, InputAction::MoveForward);
+    input.Bind(GLFW_KEY_S, InputAction::MoveBack);
+    input.Bind(GLFW_KEY_A, InputAction::MoveLeft);
+    input.Bind(GLFW_KEY_D, InputAction::MoveRight);
+    input.Bind(GLFW_KEY_F1, InputAction::ToggleVSync, true);
+    input.Bind(GLFW_KEY_E, InputAction::Interact);
+    input.Bind(GLFW_KEY_F2, InputAction::CaptureTrace);
+}
 
-    mTimer.Reset();
-    while (!glfwWindowShouldClose(window)) {
-        mTimer.Tick();
-        CalculateFPS();
-        glfwPollEvents();
+void Engine::InitializeScene() {
+    cubeAsset = assets.RequestMesh("assets/meshes/cube.bmesh");
+    cubeMesh = cubeAsset.Mesh();
+    if (cubeMesh == InvalidMesh) {
+        Log.warning("Falling back to the built-in cube");
+        cubeMesh = pRenderer->CreateMesh({ CubeVertices, static_cast<uint32_t>(std::size(CubeVertices)),
+            CubeIndices, static_cast<uint32_t>(std::size(CubeIndices)) });
+    }
 
-        constexpr float speed = 0.05f;
+    scene.Reserve(2 + static_cast<size_t>(opts.stressObjects));
+    ground = scene.Create(cubeMesh, { 0, -1, 0 }, { 0, 0, 0 }, { 10, 1, 10 });
+    cube = scene.Create(cubeMesh, { 0, 0, 5 }, { 0, 0, 0 }, { 1, 1, 1 });
+
+    // optional grid of small cubes above the ground, for profiling large scenes
+    const uint32_t count = opts.stressObjects;
+    const uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(count))));
+    constexpr float spacing = 1.5f;
+    for (uint32_t i = 0; i < count; ++i) {
+        const float x = (static_cast<float>(i % side) - 0.5f * side) * spacing;
+        const float z = (static_cast<float>(i / side) - 0.5f * side) * spacing;
+        scene.Create(cubeMesh, { x, 2.0f, z }, { 0, 0, 0 }, { 0.5f, 0.5f, 0.5f });
+    }
+    Log.info("Scene created with " + std::to_string(scene.Size()) + " objects");
+}
 
-        XMVECTOR pos = XMLoadFloat3(&pController->m_Pos);
-        XMVECTOR unitForward = pController->GetForward() * speed;
+void Engine::Update(float frameTime) {
+    PROFILE_ZONE("Update");
+
+    // takes what the window reported so far; actions and looking around apply once per frame,
+    // held keys once per step below
+    const double now = window ? glfwGetTime() : 0.0;
+    input.BeginFrame();
+    HandleActions();
+    HandleLook();
+
+    mAccumulator += frameTime;
+    uint32_t steps{ 0 };
+    while (mAccumulator >= FixedTimeStep && steps < MaxSimulationSteps) {
+        // the step ends where the simulation catches up with the clock, less the time left for later steps
+        input.Tick(now - (mAccumulator - FixedTimeStep));
+        Simulate(FixedTimeStep);
+        mAccumulator -= FixedTimeStep;
+        ++steps;
+    }
+    if (mAccumulator >= FixedTimeStep) {
+        // a long stall (breakpoint, window drag) is dropped instead of being replayed
+        mAccumulator = std::fmod(mAccumulator, FixedTimeStep);
+    }
 
-        if (glfwGetKey(window, GLFW_KEY_W)) {
-            XMVECTOR newPos = XMVectorAdd(pos, unitForward);
-            XMStoreFloat3(&pController->m_Pos, newPos);
-        }
-        if (glfwGetKey(window, GLFW_KEY_S)) {
-            XMVECTOR newPos = XMVectorAdd(pos, -unitForward);
-            XMStoreFloat3(&pController->m_Pos, newPos);
-        }
-        if (glfwGetKey(window, GLFW_KEY_A)) {
-            XMVECTOR left = XMVector3Cross(unitForward, XMVECTOR{0, 1, 0});
-            XMVECTOR newPos = XMVectorAdd(pos, left);
-            XMStoreFloat3(&pController->m_Pos, newPos);
+    ReloadChangedFiles();
+
+    // uploads are capped per frame, a burst of finished loads spreads over several frames instead of hitching one
+    constexpr float assetUploadBudgetMs = 2.0f;
+    if (assets.HasFinishedLoads()) {
+        renderThread.WaitIdle();
+        assets.Finalize(assetUploadBudgetMs);
+    }
+
+    scene.UpdateTransforms();
+    scene.UpdateSpatialIndex();
+}
+
+// shaders are swapped right away, meshes go through the streaming queue and are swapped in Finalize;
+// both happen while the render thread is idle, so no frame mixes old and new
+void Engine::ReloadChangedFiles() {
+    changedFiles.clear();
+    fileWatcher.Poll(changedFiles);
+    if (changedFiles.empty()) {
+        return;
+    }
+    PROFILE_ZONE("Hot Reload");
+
+    const auto hasExtension = [](const std::string& path, const char* extension) {
+        const size_t length = std::char_traits<char>::length(extension);
+        return path.size() >= length && path.compare(path.size() - length, length, extension) == 0;
+    };
+    for (const std::string& path : changedFiles) {
+        if (hasExtension(path, ".hlsl")) {
+            renderThread.WaitIdle();
+            if (!pRenderer->ReloadShader(path)) {
+                Log.warning("[HotReload] " + path + " failed to compile, keeping the previous shaders");
+            }
         }
-        if (glfwGetKey(window, GLFW_KEY_D)) {
-            XMVECTOR right = -XMVector3Cross(unitForward, XMVECTOR{ 0, 1, 0 });
-            XMVECTOR newPos = XMVectorAdd(pos, right);
-            XMStoreFloat3(&pController->m_Pos, newPos);
+        else if (hasExtension(path, ".bmesh") && assets.Reload(path)) {
+            Log.info("[HotReload] reloading " + path);
         }
+    }
+}
 
-        pRenderer->BeginFrame();
-        
-        // optional
-        pRenderer->ClearBackground({ 0, 0, 0, 255 });
-        pRenderer->DrawCube(pController.get(), groundPos, groundRot, groundScaling);
-        pRenderer->DrawCube(pController.get(), cubePos, cubeRot, cubeScaling);
+// one fixed step of gameplay, dt is always FixedTimeStep
+void Engine::Simulate(float dt) {
+    PROFILE_ZONE("Simulate");
+    mPrevPlayerPos = pController->m_Pos;
 
+    // how much of the step each key was held, a tap shorter than a step moves for as long as it lasted;
+    // without a window nothing is ever held, the movement math still runs
+    const float forward = input.Held(InputAction::MoveForward) - input.Held(InputAction::MoveBack);
+    const float left = input.Held(InputAction::MoveLeft) - input.Held(InputAction::MoveRight);
 
-        pRenderer->EndFrame();
-    }
+    constexpr float speed = 3.0f; // units per second
+    constexpr Vec3 up{ 0.0f, 1.0f, 0.0f };
+
+    Vec3 unitForward = pController->GetForward() * (speed * dt);
+
+    pController->m_Pos += unitForward * forward;
+    pController->m_Pos += Cross(unitForward, up) * left;
 }
 
-void Engine::Shutdown() {
-    Log.info("Shutting down engine...");
+void Engine::Render() {
+    PROFILE_ZONE("Render");
 
-    Log.info("Shutting down renderer...");
-    pRenderer->Shutdown();
+    // blend the last two simulation steps by how far into the next one this frame is,
+    // looking around is applied right away so the mouse never lags behind
+    const float alpha = mAccumulator / FixedTimeStep;
+    const Vec3 eye = Lerp(mPrevPlayerPos, pController->m_Pos, alpha);
 
-    /* GLFW AND WINDOW DESTRUCTION */
-    Log.info("Destroying window and GLFW");
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    // matrices are only rebuilt when the view or aspect ratio actually changed
+    camera.SetView(eye, pController->GetView());
+    camera.SetAspectRatio(pRenderer->AspectRatio());
+    camera.Update();
+
+    // recorded here, drawn on the render thread while the next frame is simulated
+    RenderCommandList& list = renderThread.Recording();
+    list.SetCamera(camera);
+
+    // optional
+    list.ClearBackground({ 0, 0, 0, 255 });
+    // dense indices of what survived culling, scratch in the frame arena that Run resets every frame
+    FrameVector<uint32_t> visible{};
+    scene.Cull(camera.GetFrustum(), visible);
+    scene.SelectLods(camera, static_cast<float>(viewportHeight), visible);
+    scene.Submit(list, visible);
+
+    renderThread.Submit();
 }
 
-/* Private Functions */
-void Engine::InitializeLogging() {
-#ifdef _DEBUG
-    AllocConsole();
-    SetConsoleTitle(TEXT("Debug Console"));
-    freopen_s(reinterpret_cast<FILE**>(stdout), "CONOUT$", "w", stdout);
-    freopen_s(reinterpret_cast<FILE**>(stdin), "CONIN$", "r", stdin);
-    freopen_s(reinterpret_cast<FILE**>(stderr), "CONOUT$", "w", stderr);
-#endif
-    Logger::Init();
-    Log.info("----- Logging Started -----");
+void Engine::RunHeadless() {
+    const uint32_t frameCount = opts.headlessFrames;
+    const float dt = opts.headlessDeltaTime;
+    Log.info("Headless run: " + std::to_string(frameCount) + " frames at a fixed dt of " + std::to_string(dt) + "s");
+
+    std::vector<float> frameTimes{};
+    frameTimes.reserve(frameCount);
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point runStart = Clock::now();
+    float simulatedTime{ 0.0f };
+
+    for (uint32_t frame = 0; frame < frameCount; ++frame) {
+        const Clock::time_point frameStart = Clock::now();
+        Profiler::Get().BeginFrame();
+        FrameArena::Get().Reset();
+
+        // no input without a window, sweep the view so objects move in and out of frame
+        simulatedTime += dt;
+        constexpr float yawSpeed = 45.0f; // degrees per simulated second
+        pController->m_Rotation.x = std::fmod(simulatedTime * yawSpeed, 360.0f);
+
+        Update(dt);
+        Render();
+        Profiler::Get().EndFrame();
+
+        frameTimes.push_back(std::chrono::duration<float, std::milli>(Clock::now() - frameStart).count());
+    }
+    renderThread.WaitIdle();
+
+    const float totalMs = std::chrono::duration<float, std::milli>(Clock::now() - runStart).count();
+    if (frameTimes.empty()) {
+        return;
+    }
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    std::ostringstream oss{};
+    oss.precision(4);
+    oss << std::fixed
+        << "Frame times (ms) over " << frameTimes.size() << " frames:"
+        << " avg " << totalMs / static_cast<float>(frameTimes.size())
+        << " min " << frameTimes.front()
+        << " p50 " << Percentile(frameTimes, 50.0f)
+        << " p90 " << Percentile(frameTimes, 90.0f)
+        << " p95 " << Percentile(frameTimes, 95.0f)
+        << " p99 " << Percentile(frameTimes, 99.0f)
+        << " max " << frameTimes.back();
+    Log.info(oss.str());
+
+    // warm-up frames grow buffers once, after that a frame should not touch the heap
+    const FrameStats stats = Profiler::Get().GetFrameStats();
+    Log.info("Heap allocations per frame: avg " + std::to_string(stats.averageAllocations) + " max " + std::to_string(stats.maxAllocations)
+        + ", " + std::to_string(stats.allocatingFrames) + " of " + std::to_string(stats.frames) + " frames allocated");
+
+    const RenderStats renderStats = pRenderer->GetRenderStats();
+    Log.info("Last frame: " + std::to_string(renderStats.draws) + " draws, " + std::to_string(renderStats.triangles) + " triangles, "
+        + std::to_string(renderStats.binds) + " state binds, "
+        + std::to_string(renderStats.redundantBinds) + " redundant binds filtered");
 }
 
 void Engine::CalculateFPS() {
@@ -131,61 +432,74 @@ void Engine::CalculateFPS() {
     if ((currentTime - timeElapsed) >= interval) {
         float fps = static_cast<float>(frameCount) / interval;
 
-        std::wostringstream oss{};
-        oss.precision(6);
-        oss << TEXT("FPS: ") << fps;
-        SetWindowText(hWnd, oss.str().c_str());
+        // the average hides spikes, show the frame time distribution next to it
+        const FrameStats stats = Profiler::Get().GetFrameStats();
+        Profiler::Get().ResetFrameStats();
+
+        // formatted on the stack, the title is updated inside a frame that should not touch the heap
+        const RenderStats renderStats = pRenderer->GetRenderStats();
+        char title[256]{};
+        std::snprintf(title, sizeof(title), "FPS: %.2f  frame ms p50 %.2f p95 %.2f p99 %.2f max %.2f  allocs/frame avg %.1f max %u  draws %u tris %u binds %u",
+            fps, stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs, stats.averageAllocations, stats.maxAllocations, renderStats.draws, renderStats.triangles, renderStats.binds);
+        glfwSetWindowTitle(window, title);
         frameCount = 0;
         timeElapsed = currentTime;
     }
 }
 
 /* object handlers */
-void Engine::HandleKey(int key, int action) {
-    if (key == GLFW_KEY_F1 && (action == GLFW_PRESS || action == GLFW_REPEAT)) {
+void Engine::HandleActions() {
+    // every press toggles, so an even number of them cancels out
+    if (input.Presses(InputAction::ToggleVSync) % 2 == 1) {
+        // the render thread reads the option when presenting
+        renderThread.WaitIdle();
         opts.vSync = !opts.vSync;
         Log.info("vSync: " + std::string((opts.vSync ? "on" : "off")));
     }
-}
-void Engine::HandleCursor(double x, double y) {
-    static bool firstmouse{ true };
-    if (firstmouse) {
-        PrevCursor.x = x;
-        PrevCursor.y = y;
-        firstmouse = false;
+    if (input.Presses(InputAction::Interact) > 0) {
+        // pick whatever is straight ahead of the view
+        constexpr float maxDistance = 1000.0f;
+        EntityHandle hit{};
+        float distance{};
+        if (scene.RayCast({ pController->m_Pos, pController->GetView() }, maxDistance, hit, distance)) {
+            Log.info("Looking at entity " + std::to_string(hit.index) + " at distance " + std::to_string(distance));
+        }
+        else {
+            Log.info("Looking at nothing");
+        }
     }
-
-    float xoffset = x - PrevCursor.x;
-    float yoffset = PrevCursor.y - y;  // reversed: y ranges bottom to top
+    if (input.Presses(InputAction::CaptureTrace) > 0) {
+        constexpr uint32_t captureFrames = 120;
+        Profiler::Get().CaptureFrames(captureFrames, "trace.json");
+    }
+}
+void Engine::HandleLook() {
+    const Vec2 delta = input.LookDelta();
 
     constexpr float sensitivity = 0.05f;
-    xoffset *= sensitivity;
-    yoffset *= sensitivity;
-
-
-    PrevCursor.x = x;
-    PrevCursor.y = y;
-
-    pController->m_Rotation.x += xoffset;
-    pController->m_Rotation.y += yoffset;
+    pController->m_Rotation.x += delta.x * sensitivity;
+    pController->m_Rotation.y -= delta.y * sensitivity; // reversed: y ranges bottom to top
 
     pController->m_Rotation.y = std::clamp(pController->m_Rotation.y, -89.0f, 89.0f);
 }
 void Engine::HandleResize(int width, int height) {
+    renderThread.WaitIdle();
     pRenderer->OnResize(width, height);
+    viewportHeight = height;
 }
 
 /* global static callbacks */
 void Engine::GlobalKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     Engine* engine = reinterpret_cast<Engine*>(glfwGetWindowUserPointer(window));
     if (engine) {
-        engine->HandleKey(key, action);
+        const KeyState state = action == GLFW_PRESS ? KeyState::Press : action == GLFW_RELEASE ? KeyState::Release : KeyState::Repeat;
+        engine->input.PushKey(key, state, glfwGetTime());
     }
 }
 void Engine::GlobalCursorCallback(GLFWwindow* window, double xpos, double ypos) {
     Engine* engine = reinterpret_cast<Engine*>(glfwGetWindowUserPointer(window));
     if (engine) {
-        engine->HandleCursor(xpos, ypos);
+        engine->input.PushCursor(xpos, ypos, glfwGetTime());
     }
 }
 // only called once window is "confirmed" to be resized, e.g. when you let go of the window resize bar
@@ -9,21 +9,38 @@
 
 #pragma once
 #include "IEngine.h"
-#define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3.h>
+#ifdef _WIN32
+#define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3native.h>
 #include <Windows.h>
-#include <memory>
 #include "Renderer/D3DRenderer.h"
+#endif
+#include <memory>
+#include "Renderer/SoftwareRenderer.h"
+#include "Renderer/NullRenderer.h"
 #include "Renderer/RendererOptions.h"
+#include "Renderer/RenderThread.h"
 #include "Timer.h"
+#include "FramePacer.h"
 #include "Util/Math/Vectors.h"
 #include "Util/Math/Mat4.h"
 #include "PlayerController.h"
+#include "Camera.h"
+#include "Scene/Scene.h"
+#include "Jobs/JobSystem.h"
+#include "Profiler/Profiler.h"
+#include "Memory/FrameArena.h"
+#include "Assets/AssetManager.h"
+#include "Assets/FileWatcher.h"
+#include "Input/Input.h"
+#include <string>
+#include <vector>
 
 class Engine : public IEngine {
 public:
 	Engine() = default;
+	explicit Engine(const RendererOptions& options);
 	~Engine() override;
 	bool Initialize() override;
 	void Run() override;
@@ -31,35 +48,55 @@ public:
 private:
 	/* window */
 	GLFWwindow* window{ nullptr };
-	HWND hWnd{};
+	NativeWindow hWnd{};
 	/* renderer */
 	std::unique_ptr<IRenderer> pRenderer{ nullptr };
+	RenderThread renderThread{}; // draws frame N-1 while the main thread builds frame N
 	RendererOptions opts{};
 
 	/* game */
 	Timer mTimer{};
+	FramePacer mPacer{};
 
-	std::unique_ptr<PlayerController> pController{ nullptr };
+	// the simulation always advances in steps of FixedTimeStep, rendering blends between the last two steps
+	static constexpr float FixedTimeStep = 1.0f / 60.0f;
+	// catch-up steps per frame, beyond this the simulation slows down instead of spiralling
+	static constexpr uint32_t MaxSimulationSteps = 5;
+	float mAccumulator{ 0.0f };
+	Vec3 mPrevPlayerPos{ 0.0f, 0.0f, 0.0f };
 
-	Vec2 PrevCursor{ 0, 0 };
-
-	Mat4 identity{};
-	Vec3 cubePos{ 0, 0, 5 };
-	Vec3 cubeRot{ 0, 0, 0 };
-	Vec3 cubeScaling{ 1, 1, 1 };
-
-	Vec3 groundPos{ 0, -1, 0 };
-	Vec3 groundRot{ 0, 0, 0 };
-	Vec3 groundScaling{ 10, 1, 10 };
+	std::unique_ptr<PlayerController> pController{ nullptr };
+	Camera camera{};
+	int viewportHeight{}; // pixels, for projecting level of detail errors
 
+	Input input{}; // filled by the window callbacks, drained once per frame and per simulation step
 
+	Scene scene{};
+	AssetManager assets{};
+	MeshRef cubeAsset{}; // declared after assets so it is released first
+	MeshHandle cubeMesh{ InvalidMesh };
+	EntityHandle cube{};
+	EntityHandle ground{};
 
+	FileWatcher fileWatcher{}; // assets/, when hot reload is on
+	std::vector<std::string> changedFiles{};
 
 	void InitializeLogging();
+	void InitializeScene();
+	bool InitializeWindow();
+	bool InitializeRenderer();
+	void InitializeAssets();
+	void InitializeInput();
 	void CalculateFPS();
 
-	void HandleKey(int key, int action);
-	void HandleCursor(double x, double y);
+	void Update(float frameTime);
+	void ReloadChangedFiles();
+	void Simulate(float dt);
+	void Render();
+	void RunHeadless();
+
+	void HandleActions();
+	void HandleLook();
 	void HandleResize(int width, int height);
 	static void GlobalKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 	static void GlobalCursorCallback(GLFWwindow* window, double xpos, double ypos);
@@ -0,0 +1,88 @@
+#include "FramePacer.h"
+#include "Timer.h"
+#include "Engine/Profiler/Profiler.h"
+#include <chrono>
+#include <cmath>
+#include <thread>
+#ifdef _WIN32
+#include <Windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+FramePacer::FramePacer()
+	: mSecondsPerCount{ Timer::SecondsPerCount() }
+{
+#ifdef _WIN32
+	// the default scheduler tick is ~15.6 ms, far too coarse to sleep through part of a frame
+	timeBeginPeriod(1);
+#endif
+}
+
+FramePacer::~FramePacer() {
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::SetTargetFps(float fps) {
+	mPeriod = fps > 0.0f ? static_cast<int64_t>(1.0 / (fps * mSecondsPerCount)) : 0;
+	mDeadline = 0;
+}
+
+float FramePacer::TargetFps() const {
+	return mPeriod > 0 ? static_cast<float>(1.0 / (mPeriod * mSecondsPerCount)) : 0.0f;
+}
+
+void FramePacer::Wait() {
+	if (mPeriod == 0) {
+		return;
+	}
+	PROFILE_ZONE("Frame Pacing");
+
+	const int64_t now = Timer::Now();
+	const int64_t target = mDeadline + mPeriod;
+	if (mDeadline == 0 || now - target > mPeriod) {
+		// first frame, or a whole frame behind: start over rather than rush the next frames to catch up
+		mDeadline = now;
+		return;
+	}
+	if (now < target) {
+		SleepUntil(target);
+	}
+	// keep the cadence, a slightly late frame shortens the next slot instead of shifting every frame after it
+	mDeadline = target;
+}
+
+/* private functions */
+
+void FramePacer::SleepUntil(int64_t target) {
+	// sleep in 1 ms steps while the deadline is further away than a pessimistic sleep takes
+	for (;;) {
+		const double remaining = (target - Timer::Now()) * mSecondsPerCount;
+		const double estimate = mSleepMean + std::sqrt(mSleepM2 / mSleepSamples);
+		if (remaining <= estimate) {
+			break;
+		}
+
+		const int64_t start = Timer::Now();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		const double observed = (Timer::Now() - start) * mSecondsPerCount;
+
+		// cap the history so the estimate follows changes in system load
+		if (mSleepSamples < 1000) {
+			++mSleepSamples;
+		}
+		const double delta = observed - mSleepMean;
+		mSleepMean += delta / mSleepSamples;
+		mSleepM2 += delta * (observed - mSleepMean);
+		if (mSleepSamples == 1000) {
+			mSleepM2 *= 0.999;
+		}
+	}
+
+	// the rest is shorter than the scheduler can be trusted with
+	while (Timer::Now() < target) {
+		std::this_thread::yield();
+	}
+}
\ No newline at end of file
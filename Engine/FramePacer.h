@@ -0,0 +1,33 @@
+//
+// Frame Pacer
+// Holds the main loop to a target frame time when vSync is off:
+// sleeps while the deadline is far away, then spins the last stretch
+// The spin window adapts to how late the OS actually wakes the thread
+//
+
+#pragma once
+#include <cstdint>
+
+class FramePacer {
+public:
+	FramePacer();
+	~FramePacer();
+
+	// 0 disables pacing
+	void SetTargetFps(float fps);
+	float TargetFps() const;
+
+	// call once per frame, returns at the end of the frame's time slot
+	void Wait();
+private:
+	double mSecondsPerCount{};
+	int64_t mPeriod{};   // target frame time, in Timer counts
+	int64_t mDeadline{}; // end of the previous frame's slot
+
+	// running mean and variance of how long a 1 ms sleep really takes (Welford)
+	double mSleepMean{ 0.002 };
+	double mSleepM2{ 0.0 };
+	uint32_t mSleepSamples{ 1 };
+
+	void SleepUntil(int64_t target);
+};
\ No newline at end of file
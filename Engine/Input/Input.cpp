@@ -0,0 +1,132 @@
+#include "Input.h"
+#include "Util/Log.h"
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+Input::Input()
+{
+	// room for a full queue, taking events does not allocate
+	keyEvents.reserve(QueueCapacity);
+}
+
+void Input::Bind(int32_t key, InputAction action, bool repeats) {
+	bindings.push_back({ key, action, repeats });
+}
+
+/* producer */
+
+void Input::PushKey(int32_t key, KeyState state, double time) {
+	InputEvent event{};
+	event.type = InputEvent::Type::Key;
+	event.state = state;
+	event.key = key;
+	event.time = time;
+	if (!queue.Push(event)) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void Input::PushCursor(double x, double y, double time) {
+	InputEvent event{};
+	event.type = InputEvent::Type::Cursor;
+	event.x = x;
+	event.y = y;
+	event.time = time;
+	if (!queue.Push(event)) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+/* consumer */
+
+void Input::BeginFrame() {
+	for (ActionState& state : actions) {
+		state.presses = 0;
+	}
+	lookX = 0.0;
+	lookY = 0.0;
+
+	InputEvent event{};
+	while (queue.Pop(event)) {
+		if (event.type == InputEvent::Type::Cursor) {
+			// the first position only sets the origin, otherwise the view jumps to wherever the cursor started
+			if (hasCursor) {
+				lookX += event.x - cursorX;
+				lookY += event.y - cursorY;
+			}
+			hasCursor = true;
+			cursorX = event.x;
+			cursorY = event.y;
+			continue;
+		}
+
+		const Binding* binding = Find(event.key);
+		if (!binding) {
+			continue;
+		}
+		ActionState& state = actions[static_cast<size_t>(binding->action)];
+		if (event.state == KeyState::Press || (event.state == KeyState::Repeat && binding->repeats)) {
+			++state.presses;
+		}
+		if (event.state != KeyState::Repeat) {
+			keyEvents.push_back({ binding->action, event.state, event.time });
+		}
+	}
+
+	const uint32_t lost = dropped.exchange(0, std::memory_order_relaxed);
+	if (lost > 0) {
+		Log.warning("[Input] event queue full, dropped " + std::to_string(lost) + " events");
+	}
+}
+
+void Input::Tick(double end) {
+	const double start = stepStarted ? std::min(stepStart, end) : end;
+	for (ActionState& state : actions) {
+		state.downSince = start;
+		state.heldTime = 0.0;
+	}
+
+	// events from before the step (the clock stalled or the first step) count from its start
+	size_t applied = 0;
+	for (; applied < keyEvents.size() && keyEvents[applied].time <= end; ++applied) {
+		const KeyEvent& event = keyEvents[applied];
+		ActionState& state = actions[static_cast<size_t>(event.action)];
+		const double time = std::clamp(event.time, start, end);
+		if (event.state == KeyState::Press) {
+			if (state.keysDown++ == 0) {
+				state.downSince = time;
+			}
+		}
+		else if (state.keysDown > 0 && --state.keysDown == 0) {
+			state.heldTime += time - state.downSince;
+		}
+	}
+	keyEvents.erase(keyEvents.begin(), keyEvents.begin() + static_cast<std::ptrdiff_t>(applied));
+
+	const double length = end - start;
+	for (ActionState& state : actions) {
+		if (state.keysDown > 0) {
+			state.heldTime += end - state.downSince;
+		}
+		if (length > 0.0) {
+			state.held = static_cast<float>(std::min(state.heldTime / length, 1.0));
+		}
+		else {
+			state.held = state.keysDown > 0 ? 1.0f : 0.0f;
+		}
+	}
+	stepStart = end;
+	stepStarted = true;
+}
+
+/* private functions */
+
+const Input::Binding* Input::Find(int32_t key) const {
+	for (const Binding& binding : bindings) {
+		if (binding.key == key) {
+			return &binding;
+		}
+	}
+	return nullptr;
+}
\ No newline at end of file
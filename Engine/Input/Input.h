@@ -0,0 +1,106 @@
+//
+// Input
+// Window callbacks only push timestamped events into a lock-free queue; the consumer
+// drains it and maps keys to actions, so gameplay never asks the window for key state
+// - BeginFrame takes every queued event: cursor moves add up to the look delta, key
+//   presses are counted per action, key events are kept for the simulation steps
+// - Tick(end) applies the kept key events up to end and measures how long each action
+//   was held during the step, so a tap shorter than a step still counts for its length
+// Everything but Push* runs on one consumer thread, which does not have to be the one
+// polling the window
+//
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "SpscQueue.h"
+#include "Util/Math/Vectors.h"
+
+enum class InputAction : uint8_t {
+	MoveForward,
+	MoveBack,
+	MoveLeft,
+	MoveRight,
+	ToggleVSync,
+	Interact,
+	CaptureTrace,
+	Count,
+};
+
+enum class KeyState : uint8_t { Press, Release, Repeat };
+
+struct InputEvent {
+	enum class Type : uint8_t { Key, Cursor };
+	Type type{ Type::Key };
+	KeyState state{ KeyState::Press };
+	int32_t key{};
+	double x{}, y{}; // cursor position in pixels
+	double time{};   // seconds, on the same clock as the times passed to Tick
+};
+
+class Input {
+public:
+	Input();
+
+	// several keys may trigger one action, a key triggers one; repeats makes held key repeats count as presses
+	void Bind(int32_t key, InputAction action, bool repeats = false);
+
+	/* producer, one thread at a time, e.g. inside the window's event callbacks */
+	void PushKey(int32_t key, KeyState state, double time);
+	void PushCursor(double x, double y, double time);
+
+	/* consumer */
+	void BeginFrame();
+	// the step ending at end (and starting where the previous one ended)
+	void Tick(double end);
+
+	// presses since BeginFrame
+	uint32_t Presses(InputAction action) const { return actions[static_cast<size_t>(action)].presses; }
+	// share of the last step the action was held for, 0 to 1
+	float Held(InputAction action) const { return actions[static_cast<size_t>(action)].held; }
+	// cursor movement since the previous BeginFrame, summed over every event
+	Vec2 LookDelta() const { return { static_cast<float>(lookX), static_cast<float>(lookY) }; }
+
+	Input(const Input&) = delete;
+	Input& operator=(const Input&) = delete;
+private:
+	// a frame at a 8 kHz mouse polling rate and a low frame rate fits easily
+	static constexpr uint32_t QueueCapacity = 4096;
+
+	struct Binding {
+		int32_t key;
+		InputAction action;
+		bool repeats;
+	};
+
+	struct KeyEvent {
+		InputAction action;
+		KeyState state;
+		double time;
+	};
+
+	struct ActionState {
+		uint32_t presses{};
+		uint32_t keysDown{};   // bound keys currently held
+		double downSince{};    // when keysDown last became non-zero, clamped to the step start
+		double heldTime{};     // within the current step
+		float held{};
+	};
+
+	SpscQueue<InputEvent> queue{ QueueCapacity };
+	std::atomic<uint32_t> dropped{ 0 }; // events lost because the queue was full, logged by BeginFrame
+
+	std::vector<Binding> bindings{};
+	ActionState actions[static_cast<size_t>(InputAction::Count)]{};
+
+	std::vector<KeyEvent> keyEvents{}; // taken by BeginFrame, not yet applied by a step
+	double stepStart{};
+	bool stepStarted{ false };
+
+	bool hasCursor{ false };
+	double cursorX{}, cursorY{};
+	double lookX{}, lookY{}; // summed in double, positions grow large with a disabled cursor
+
+	const Binding* Find(int32_t key) const;
+};
\ No newline at end of file
@@ -0,0 +1,55 @@
+//
+// SPSC Queue
+// Fixed capacity lock-free ring for one producer thread and one consumer thread
+// Head and tail only ever grow, so full and empty never look alike
+//
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+template <typename T>
+class SpscQueue {
+public:
+	// capacity is rounded up to a power of two
+	explicit SpscQueue(uint32_t capacity = 4096) {
+		uint32_t size = 1;
+		while (size < capacity) {
+			size <<= 1;
+		}
+		mItems.resize(size);
+		mMask = size - 1;
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	// producer only, false when full
+	bool Push(const T& item) {
+		const uint64_t tail = mTail.load(std::memory_order_relaxed);
+		if (tail - mHead.load(std::memory_order_acquire) > mMask) {
+			return false;
+		}
+		mItems[tail & mMask] = item;
+		mTail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer only
+	bool Pop(T& item) {
+		const uint64_t head = mHead.load(std::memory_order_relaxed);
+		if (head == mTail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		item = mItems[head & mMask];
+		mHead.store(head + 1, std::memory_order_release);
+		return true;
+	}
+private:
+	std::vector<T> mItems{};
+	uint64_t mMask{};
+	// on separate cache lines, the producer writes one and the consumer the other
+	alignas(64) std::atomic<uint64_t> mHead{ 0 };
+	alignas(64) std::atomic<uint64_t> mTail{ 0 };
+};
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "JobBenchmark.h"
+#include "JobSystem.h"
+#include "WorkStealingQueue.h"
+#include "Util/Log.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	constexpr uint32_t QueueOps = 1u << 20;
+	// jobs scheduled between waits, well below the per thread queue capacity so none run inline
+	constexpr uint32_t JobBatch = 1024;
+	constexpr uint32_t EmptyJobs = 256 * JobBatch;
+	constexpr uint32_t ParallelCount = 1u << 22;
+	// best of, the first runs also fault the output pages in
+	constexpr int Repeats = 5;
+
+	double Nanoseconds(Clock::time_point start, uint32_t count) {
+		return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+	}
+
+	void EmptyJob(void*, uint32_t, uint32_t) {}
+
+	// push and pop on the owning thread, then a second thread steals everything
+	void BenchQueue() {
+		WorkStealingQueue<Job> queue{ QueueOps };
+		Job job{};
+		job.function = EmptyJob;
+
+		Clock::time_point start = Clock::now();
+		for (uint32_t i = 0; i < QueueOps; ++i) {
+			queue.Push(job);
+		}
+		const double pushNs = Nanoseconds(start, QueueOps);
+		start = Clock::now();
+		Job popped{};
+		while (queue.Pop(popped)) {}
+		const double popNs = Nanoseconds(start, QueueOps);
+
+		for (uint32_t i = 0; i < QueueOps; ++i) {
+			queue.Push(job);
+		}
+		double stealNs{};
+		std::thread thief([&queue, &stealNs] {
+			const Clock::time_point stealStart = Clock::now();
+			Job stolen{};
+			uint32_t count{ 0 };
+			while (count < QueueOps) {
+				count += queue.Steal(stolen) ? 1 : 0;
+			}
+			stealNs = Nanoseconds(stealStart, QueueOps);
+		});
+		thief.join();
+
+		std::ostringstream oss{};
+		oss.precision(3);
+		oss << "[Bench] queue: push " << pushNs << " ns, pop " << popNs << " ns, uncontended steal " << stealNs << " ns";
+		Log.info(oss.str());
+	}
+
+	// schedule and wait on empty jobs, the cost of handing work to the other threads
+	double BenchEmptyJobs() {
+		JobSystem& jobs = JobSystem::Get();
+		Job job{};
+		job.function = EmptyJob;
+		JobCounter counter{};
+		job.counter = &counter;
+
+		const Clock::time_point start = Clock::now();
+		for (uint32_t batch = 0; batch < EmptyJobs / JobBatch; ++batch) {
+			for (uint32_t i = 0; i < JobBatch; ++i) {
+				jobs.Schedule(job);
+			}
+			jobs.Wait(counter);
+		}
+		return Nanoseconds(start, EmptyJobs);
+	}
+
+	// a few dependent multiply-adds per element, compute bound so the scaling shows the scheduler
+	double BenchParallelFor(std::vector<float>& output) {
+		double best{ 1e30 };
+		for (int repeat = 0; repeat < Repeats; ++repeat) {
+			const Clock::time_point start = Clock::now();
+			JobSystem::Get().ParallelFor(ParallelCount, 0, [&output](uint32_t begin, uint32_t end) {
+				for (uint32_t i = begin; i < end; ++i) {
+					float x = static_cast<float>(i & 1023);
+					for (int step = 0; step < 64; ++step) {
+						x = x * 0.999f + 0.5f;
+					}
+					output[i] = x;
+				}
+			});
+			best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+		}
+		return best;
+	}
+}
+
+bool RunJobBenchmark(uint32_t maxThreads) {
+	if (maxThreads == 0) {
+		maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	Log.info("[Bench] job system, 1 to " + std::to_string(maxThreads) + " threads");
+	BenchQueue();
+
+	std::vector<float> output(ParallelCount);
+	std::vector<float> reference{};
+	double baseSeconds{};
+	for (uint32_t threads = 1; threads <= maxThreads; ++threads) {
+		// one thread runs without workers, ParallelFor and Schedule then call the function inline
+		if (threads > 1) {
+			JobSystem::Get().Initialize(threads - 1);
+		}
+		const double jobNs = BenchEmptyJobs();
+		const double seconds = BenchParallelFor(output);
+		JobSystem::Get().Shutdown();
+
+		if (threads == 1) {
+			baseSeconds = seconds;
+			reference = output;
+		}
+		else if (output != reference) {
+			Log.error("[Bench] ParallelFor on " + std::to_string(threads) + " threads produced a different result");
+			return false;
+		}
+
+		std::ostringstream oss{};
+		oss.precision(4);
+		oss << "[Bench] " << threads << " threads: empty job " << jobNs << " ns, ParallelFor "
+			<< ParallelCount / seconds * 1e-6 << " M items/s, speedup " << baseSeconds / seconds
+			<< ", efficiency " << 100.0 * baseSeconds / seconds / threads << "%";
+		Log.info(oss.str());
+	}
+	return true;
+}
\ No newline at end of file
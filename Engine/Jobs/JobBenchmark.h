@@ -0,0 +1,12 @@
+//
+// Job Benchmark
+// -bench-jobs: overhead of the work stealing queue and the job system, and how
+// ParallelFor scales from one thread up to maxThreads
+// Reinitializes JobSystem for every thread count, so it must not be running
+//
+
+#pragma once
+#include <cstdint>
+
+// maxThreads 0 goes up to the number of cores
+bool RunJobBenchmark(uint32_t maxThreads = 0);
\ No newline at end of file
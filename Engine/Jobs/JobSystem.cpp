@@ -0,0 +1,179 @@
+#include "JobSystem.h"
+#include "Engine/Profiler/Profiler.h"
+#include <string>
+
+namespace {
+	constexpr uint32_t NoQueue = UINT32_MAX;
+	thread_local uint32_t tlsQueue{ NoQueue };
+	thread_local uint32_t tlsRandom{ 0x9E3779B9u };
+
+	// xorshift, only used to pick a victim to steal from
+	uint32_t NextRandom() {
+		uint32_t x = tlsRandom;
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		tlsRandom = x;
+		return x;
+	}
+
+	// failed steal rounds before a worker goes to sleep
+	constexpr int SpinRounds = 64;
+}
+
+JobSystem& JobSystem::Get() {
+	static JobSystem instance;
+	return instance;
+}
+
+JobSystem::~JobSystem()
+{
+	Shutdown();
+}
+
+void JobSystem::Initialize(uint32_t workerCount/*  = 0  */, uint32_t maxAttachedThreads/*  = 2  */) {
+	if (!queues.empty()) {
+		return;
+	}
+	if (workerCount == 0) {
+		workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+	}
+
+	// queue 0 belongs to the calling thread, then workers, then attached threads
+	const uint32_t queueCount = 1 + workerCount + maxAttachedThreads;
+	for (uint32_t i = 0; i < queueCount; ++i) {
+		queues.push_back(std::make_unique<ThreadQueue>());
+	}
+	attachedQueues.store(1 + workerCount, std::memory_order_relaxed);
+	queuedJobs.store(0, std::memory_order_relaxed);
+	tlsQueue = 0;
+
+	quit = false;
+	for (uint32_t i = 0; i < workerCount; ++i) {
+		workers.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+	}
+}
+
+void JobSystem::Shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		quit = true;
+	}
+	wake.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+	queues.clear();
+	tlsQueue = NoQueue;
+}
+
+bool JobSystem::AttachThread() {
+	if (tlsQueue != NoQueue) {
+		return true;
+	}
+	const uint32_t index = attachedQueues.fetch_add(1, std::memory_order_relaxed);
+	if (index >= queues.size()) {
+		return false;
+	}
+	tlsQueue = index;
+	tlsRandom ^= index * 0x85EBCA6Bu;
+	return true;
+}
+
+bool JobSystem::CanSchedule() const {
+	return tlsQueue != NoQueue && tlsQueue < queues.size() && !workers.empty();
+}
+
+/* scheduling */
+void JobSystem::Schedule(const Job& job) {
+	if (job.counter) {
+		job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+	}
+	if (!CanSchedule() || !queues[tlsQueue]->jobs.Push(job)) {
+		// no queue or it is full, do it now
+		RunJob(job);
+		return;
+	}
+
+	// pairs with the sleepers increment in WorkerLoop, either we see the sleeper or it sees the job
+	queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+	if (sleepers.load(std::memory_order_seq_cst) > 0) {
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		wake.notify_one();
+	}
+}
+
+void JobSystem::Wait(const JobCounter& counter) {
+	while (!counter.Done()) {
+		if (!TryRunJob()) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+/* execution */
+void JobSystem::WorkerLoop(uint32_t queueIndex) {
+	tlsQueue = queueIndex;
+	tlsRandom ^= queueIndex * 0x85EBCA6Bu;
+	Profiler::SetThreadName(("Job Worker " + std::to_string(queueIndex)).c_str());
+
+	int idleRounds{ 0 };
+	for (;;) {
+		if (TryRunJob()) {
+			idleRounds = 0;
+			continue;
+		}
+		if (++idleRounds < SpinRounds) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepers.fetch_add(1, std::memory_order_seq_cst);
+		wake.wait(lock, [this] { return quit || queuedJobs.load(std::memory_order_seq_cst) > 0; });
+		sleepers.fetch_sub(1, std::memory_order_relaxed);
+		if (quit) {
+			return;
+		}
+		idleRounds = 0;
+	}
+}
+
+bool JobSystem::TryRunJob() {
+	Job job{};
+	if (!TryGetJob(job)) {
+		return false;
+	}
+	queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+	RunJob(job);
+	return true;
+}
+
+bool JobSystem::TryGetJob(Job& job) {
+	if (tlsQueue == NoQueue || queues.empty()) {
+		return false;
+	}
+	if (queues[tlsQueue]->jobs.Pop(job)) {
+		return true;
+	}
+
+	// start at a random victim so thieves spread out
+	const uint32_t queueCount = static_cast<uint32_t>(queues.size());
+	const uint32_t start = NextRandom() % queueCount;
+	for (uint32_t i = 0; i < queueCount; ++i) {
+		const uint32_t victim = (start + i) % queueCount;
+		if (victim != tlsQueue && queues[victim]->jobs.Steal(job)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::RunJob(const Job& job) {
+	PROFILE_ZONE("Job");
+	job.function(job.data, job.begin, job.end);
+	if (job.counter) {
+		job.counter->pending.fetch_sub(1, std::memory_order_release);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+//
+// Job System
+// One work stealing deque per thread, idle workers steal from the others
+// Jobs are plain function pointers over an index range, completion is tracked
+// with counters that any thread can wait on (waiting threads run jobs meanwhile)
+//
+// The thread that calls Initialize owns a queue, workers own one each and other
+// threads (e.g. a render thread) get one through AttachThread. Jobs may only be
+// scheduled from those threads.
+//
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "WorkStealingQueue.h"
+
+// number of unfinished jobs, zero means everything added to it is done
+struct JobCounter {
+	std::atomic<uint32_t> pending{ 0 };
+
+	bool Done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+struct Job {
+	void (*function)(void* data, uint32_t begin, uint32_t end){ nullptr };
+	void* data{ nullptr };
+	uint32_t begin{};
+	uint32_t end{};
+	JobCounter* counter{ nullptr };
+};
+
+class JobSystem {
+public:
+	static JobSystem& Get();
+
+	// workerCount 0 picks one less than the number of cores, the calling thread works too
+	void Initialize(uint32_t workerCount = 0, uint32_t maxAttachedThreads = 2);
+	void Shutdown();
+	// gives the calling thread its own queue, so it can schedule and wait
+	bool AttachThread();
+
+	// threads that run jobs, including the initializing thread
+	uint32_t ThreadCount() const { return static_cast<uint32_t>(workers.size()) + 1; }
+
+	// counter is incremented here and decremented when the job finished
+	void Schedule(const Job& job);
+	// runs other jobs until counter reaches zero
+	void Wait(const JobCounter& counter);
+
+	// calls function(begin, end) over [0, count) in batches of at most grainSize, returns when all are done
+	// grainSize 0 splits the range into a few batches per thread
+	template <typename Function>
+	void ParallelFor(uint32_t count, uint32_t grainSize, Function&& function) {
+		if (count == 0) {
+			return;
+		}
+		if (grainSize == 0) {
+			grainSize = std::max(1u, count / (ThreadCount() * 4));
+		}
+		if (count <= grainSize || !CanSchedule()) {
+			function(0u, count);
+			return;
+		}
+
+		using FunctionType = std::remove_reference_t<Function>;
+		JobCounter counter{};
+		Job job{};
+		job.function = [](void* data, uint32_t begin, uint32_t end) { (*static_cast<FunctionType*>(data))(begin, end); };
+		job.data = const_cast<void*>(static_cast<const void*>(&function));
+		job.counter = &counter;
+
+		// the last batch runs on this thread right away
+		uint32_t begin = 0;
+		for (; begin + grainSize < count; begin += grainSize) {
+			job.begin = begin;
+			job.end = begin + grainSize;
+			Schedule(job);
+		}
+		function(begin, count);
+		Wait(counter);
+	}
+private:
+	struct ThreadQueue {
+		WorkStealingQueue<Job> jobs{};
+	};
+
+	std::vector<std::unique_ptr<ThreadQueue>> queues{};
+	std::atomic<uint32_t> attachedQueues{};
+	std::vector<std::thread> workers{};
+
+	/* sleeping */
+	std::mutex sleepMutex{};
+	std::condition_variable wake{};
+	std::atomic<int32_t> queuedJobs{};
+	std::atomic<int32_t> sleepers{};
+	bool quit{ false };
+
+	JobSystem() = default;
+	~JobSystem();
+
+	bool CanSchedule() const;
+	void WorkerLoop(uint32_t queueIndex);
+	bool TryRunJob();
+	bool TryGetJob(Job& job);
+	void RunJob(const Job& job);
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+};
\ No newline at end of file
@@ -0,0 +1,114 @@
+//
+// Work Stealing Queue
+// Fixed capacity Chase-Lev deque
+// The owning thread pushes and pops at the bottom (LIFO, cache warm),
+// any other thread steals from the top (FIFO, oldest and usually largest work)
+// A thief reads its slot before it knows the item is still there, the owner may be
+// writing that slot again after the ring wrapped; slots are relaxed atomic words so
+// that read is never a data race, a thief losing the CAS just drops what it read
+//
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+template <typename T>
+class WorkStealingQueue {
+	static_assert(std::is_trivially_copyable_v<T>, "items are copied word by word");
+public:
+	// capacity is rounded up to a power of two
+	explicit WorkStealingQueue(uint32_t capacity = 4096) {
+		uint32_t size = 1;
+		while (size < capacity) {
+			size <<= 1;
+		}
+		mItems = std::make_unique<Slot[]>(size);
+		mMask = static_cast<int64_t>(size) - 1;
+	}
+
+	WorkStealingQueue(const WorkStealingQueue&) = delete;
+	WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+	// owner only, false when full
+	bool Push(const T& item) {
+		const int64_t bottom = mBottom.load(std::memory_order_relaxed);
+		const int64_t top = mTop.load(std::memory_order_acquire);
+		if (bottom - top > mMask) {
+			return false;
+		}
+		Store(mItems[bottom & mMask], item);
+		mBottom.store(bottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	// owner only
+	bool Pop(T& item) {
+		// seq_cst store then load, a thief cannot take the item this reservation covers unseen
+		const int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+		mBottom.store(bottom, std::memory_order_seq_cst);
+		int64_t top = mTop.load(std::memory_order_seq_cst);
+
+		if (top > bottom) {
+			// empty
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		Load(mItems[bottom & mMask], item);
+		if (top == bottom) {
+			// last item, race any thief for it
+			const bool won = mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+			return won;
+		}
+		return true;
+	}
+
+	// any thread
+	bool Steal(T& item) {
+		int64_t top = mTop.load(std::memory_order_seq_cst);
+		const int64_t bottom = mBottom.load(std::memory_order_seq_cst);
+		if (top >= bottom) {
+			return false;
+		}
+
+		Load(mItems[top & mMask], item);
+		return mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	// approximate, only meaningful on the owning thread
+	bool Empty() const {
+		return mBottom.load(std::memory_order_relaxed) <= mTop.load(std::memory_order_relaxed);
+	}
+private:
+	static constexpr size_t WordCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+	struct Slot {
+		std::atomic<uint64_t> words[WordCount];
+	};
+
+	// top and bottom on their own cache lines, thieves hammer top while the owner works on bottom
+	alignas(64) std::atomic<int64_t> mTop{ 0 };
+	alignas(64) std::atomic<int64_t> mBottom{ 0 };
+	alignas(64) std::unique_ptr<Slot[]> mItems{};
+	int64_t mMask{};
+
+	static void Store(Slot& slot, const T& item) {
+		uint64_t words[WordCount]{};
+		std::memcpy(words, &item, sizeof(T));
+		for (size_t i = 0; i < WordCount; ++i) {
+			slot.words[i].store(words[i], std::memory_order_relaxed);
+		}
+	}
+
+	static void Load(const Slot& slot, T& item) {
+		uint64_t words[WordCount];
+		for (size_t i = 0; i < WordCount; ++i) {
+			words[i] = slot.words[i].load(std::memory_order_relaxed);
+		}
+		std::memcpy(&item, words, sizeof(T));
+	}
+};
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "AllocationTracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifndef BUG_DISABLE_ALLOCATION_TRACKING
+
+namespace {
+	// plain globals, constant initialized, so allocations made before main are counted too
+	std::atomic<uint64_t> allocationCount{ 0 };
+	std::atomic<uint64_t> allocatedBytes{ 0 };
+
+	void* Allocate(size_t size) {
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+		allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+		// malloc(0) may return null, new must not
+		return std::malloc(size ? size : 1);
+	}
+
+	void* AllocateAligned(size_t size, size_t alignment) {
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+		allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+#ifdef _WIN32
+		return _aligned_malloc(size ? size : 1, alignment);
+#else
+		return std::aligned_alloc(alignment, ((size ? size : 1) + alignment - 1) & ~(alignment - 1));
+#endif
+	}
+
+	void FreeAligned(void* p) {
+#ifdef _WIN32
+		_aligned_free(p);
+#else
+		std::free(p);
+#endif
+	}
+
+	void* AllocateOrThrow(size_t size) {
+		void* p = Allocate(size);
+		if (!p) {
+			throw std::bad_alloc{};
+		}
+		return p;
+	}
+
+	void* AllocateAlignedOrThrow(size_t size, size_t alignment) {
+		void* p = AllocateAligned(size, alignment);
+		if (!p) {
+			throw std::bad_alloc{};
+		}
+		return p;
+	}
+}
+
+uint64_t AllocationTracker::Allocations() {
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationTracker::BytesAllocated() {
+	return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+/* global operators */
+
+void* operator new(size_t size) { return AllocateOrThrow(size); }
+void* operator new[](size_t size) { return AllocateOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return Allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return Allocate(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void* operator new(size_t size, std::align_val_t alignment) { return AllocateAlignedOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return AllocateAlignedOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return AllocateAligned(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return AllocateAligned(size, static_cast<size_t>(alignment)); }
+
+void operator delete(void* p, std::align_val_t) noexcept { FreeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { FreeAligned(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { FreeAligned(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { FreeAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(p); }
+
+#else
+
+uint64_t AllocationTracker::Allocations() {
+	return 0;
+}
+
+uint64_t AllocationTracker::BytesAllocated() {
+	return 0;
+}
+
+#endif
\ No newline at end of file
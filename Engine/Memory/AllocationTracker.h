@@ -0,0 +1,18 @@
+//
+// Allocation Tracker
+// Replaces the global operator new/delete to count heap allocations on every
+// thread, so frames that are meant to stay off the heap can be checked
+// The profiler reports the count per frame next to the frame times
+//
+// Define BUG_DISABLE_ALLOCATION_TRACKING to keep the default operators
+//
+
+#pragma once
+#include <cstdint>
+
+class AllocationTracker {
+public:
+	// totals since startup, zero when tracking is compiled out
+	static uint64_t Allocations();
+	static uint64_t BytesAllocated();
+};
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+	constexpr size_t BlockAlignment = 64;
+
+	void* AlignedAlloc(size_t size) {
+#ifdef _WIN32
+		return _aligned_malloc(size, BlockAlignment);
+#else
+		return std::aligned_alloc(BlockAlignment, (size + BlockAlignment - 1) & ~(BlockAlignment - 1));
+#endif
+	}
+
+	void AlignedFree(void* p) {
+#ifdef _WIN32
+		_aligned_free(p);
+#else
+		std::free(p);
+#endif
+	}
+}
+
+FrameArena::FrameArena(size_t capacity)
+	: block{ static_cast<uint8_t*>(AlignedAlloc(capacity)) }, capacity{ capacity } {}
+
+FrameArena::~FrameArena() {
+	Reset();
+	AlignedFree(block);
+}
+
+FrameArena& FrameArena::Get() {
+	static FrameArena instance;
+	return instance;
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment) {
+	// padding is worked out against the address, so alignments past BlockAlignment fit in the block too
+	const uintptr_t base = reinterpret_cast<uintptr_t>(block);
+	size_t current = offset.load(std::memory_order_relaxed);
+	for (;;) {
+		const size_t begin = ((base + current + alignment - 1) & ~(alignment - 1)) - base;
+		const size_t end = begin + size;
+		if (end > capacity) {
+			break;
+		}
+		if (offset.compare_exchange_weak(current, end, std::memory_order_relaxed)) {
+			return block + begin;
+		}
+	}
+
+	// out of space, this frame pays for a heap allocation and Reset makes room for next time
+	std::lock_guard<std::mutex> lock{ overflowMutex };
+	const size_t spillAlignment = std::max(alignment, alignof(std::max_align_t));
+	void* data = ::operator new(size, std::align_val_t{ spillAlignment });
+	overflow.push_back({ data, spillAlignment });
+	overflowBytes += size + alignment;
+	return data;
+}
+
+void FrameArena::Reset() {
+	std::lock_guard<std::mutex> lock{ overflowMutex };
+	for (const Spill& spill : overflow) {
+		::operator delete(spill.data, std::align_val_t{ spill.alignment });
+	}
+	overflow.clear();
+
+	if (overflowBytes > 0) {
+		const size_t needed = capacity + overflowBytes;
+		AlignedFree(block);
+		capacity = std::max(needed, capacity * 2);
+		block = static_cast<uint8_t*>(AlignedAlloc(capacity));
+		overflowBytes = 0;
+	}
+	offset.store(0, std::memory_order_relaxed);
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+//
+// Frame Arena
+// Bump allocator for memory that only lives until the end of the frame
+// Allocating is one atomic add, so jobs can allocate from it too; Reset frees
+// everything at once at the start of the next frame
+// Requests that do not fit spill to the heap, the next Reset grows the block to
+// the frame's high water mark so that only happens on the first frame needing more
+//
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+class FrameArena {
+public:
+	explicit FrameArena(size_t capacity = 1 << 20);
+	~FrameArena();
+
+	// the main frame arena, reset by the engine in BeginFrame
+	static FrameArena& Get();
+
+	// alignment must be a power of two
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	// count default constructed elements, only for types that need no destructor
+	template <typename T>
+	T* AllocateArray(size_t count) {
+		static_assert(std::is_trivially_destructible_v<T>, "the arena never runs destructors");
+		T* data = static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+		for (size_t i = 0; i < count; ++i) {
+			new (data + i) T{};
+		}
+		return data;
+	}
+
+	// invalidates everything allocated since the last Reset, no allocation may be in progress
+	void Reset();
+
+	size_t Used() const { return offset.load(std::memory_order_relaxed); }
+	size_t Capacity() const { return capacity; }
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+private:
+	uint8_t* block{ nullptr };
+	size_t capacity{};
+	std::atomic<size_t> offset{ 0 };
+
+	struct Spill {
+		void* data;
+		size_t alignment;
+	};
+	std::mutex overflowMutex{};
+	std::vector<Spill> overflow{};
+	size_t overflowBytes{};
+};
+
+// std allocator on top of a FrameArena, deallocate is a no-op
+template <typename T>
+class ArenaAllocator {
+public:
+	using value_type = T;
+
+	explicit ArenaAllocator(FrameArena& arena = FrameArena::Get()) : arena{ &arena } {}
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : arena{ other.arena } {}
+
+	T* allocate(size_t count) { return static_cast<T*>(arena->Allocate(count * sizeof(T), alignof(T))); }
+	void deallocate(T*, size_t) {}
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+private:
+	template <typename U>
+	friend class ArenaAllocator;
+	FrameArena* arena;
+};
+
+// a vector whose storage is gone after the frame, e.g. for per-frame query results
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
\ No newline at end of file
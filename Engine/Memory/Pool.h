@@ -0,0 +1,78 @@
+//
+// Pool
+// Fixed-size object pool: objects are carved out of chunks and recycled
+// through an intrusive free list, so creating one is a pointer pop and
+// addresses never change. Not thread safe
+//
+
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+template <typename T, size_t ObjectsPerChunk = 64>
+class Pool {
+public:
+	Pool() = default;
+	~Pool() {
+		// the pool only owns memory, live objects must be destroyed by their owner first
+		assert(live == 0 && "objects still alive when their pool went away");
+	}
+
+	template <typename... Args>
+	T* Create(Args&&... args) {
+		if (!freeList) {
+			AddChunk();
+		}
+		Slot* slot = freeList;
+		freeList = slot->next;
+		++live;
+		return new (slot->storage) T(std::forward<Args>(args)...);
+	}
+
+	void Destroy(T* object) {
+		if (!object) {
+			return;
+		}
+		object->~T();
+		Slot* slot = reinterpret_cast<Slot*>(object);
+		slot->next = freeList;
+		freeList = slot;
+		--live;
+	}
+
+	// makes room for count objects without further allocations
+	void Reserve(size_t count) {
+		while (chunks.size() * ObjectsPerChunk < count) {
+			AddChunk();
+		}
+	}
+
+	size_t Live() const { return live; }
+	size_t Capacity() const { return chunks.size() * ObjectsPerChunk; }
+
+	Pool(const Pool&) = delete;
+	Pool& operator=(const Pool&) = delete;
+private:
+	union Slot {
+		Slot* next;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	std::vector<std::unique_ptr<Slot[]>> chunks{};
+	Slot* freeList{ nullptr };
+	size_t live{};
+
+	void AddChunk() {
+		std::unique_ptr<Slot[]> chunk = std::make_unique<Slot[]>(ObjectsPerChunk);
+		// thread the new slots onto the free list, lowest address first
+		for (size_t i = ObjectsPerChunk; i-- > 0;) {
+			chunk[i].next = freeList;
+			freeList = &chunk[i];
+		}
+		chunks.push_back(std::move(chunk));
+	}
+};
\ No newline at end of file
@@ -1,35 +1,32 @@
 #pragma once
-#include <DirectXMath.h>
-#include <DirectXPackedVector.h>
-
-using namespace DirectX;
+#include <cmath>
+#include "Util/Math/Vectors.h"
+#include "Util/Math/MathCommon.h"
 
 class PlayerController {
 public:
-	XMVECTOR GetView() {
-		float yawRadians = XMConvertToRadians(m_Rotation.x);
-		float pitchRadians = XMConvertToRadians(m_Rotation.y);
+	Vec3 GetView() const {
+		float yawRadians = Math::ToRadians(m_Rotation.x);
+		float pitchRadians = Math::ToRadians(m_Rotation.y);
 
-		XMVECTOR forward = XMVectorSet(
+		Vec3 forward{
 			cosf(pitchRadians) * sinf(yawRadians),
 			sinf(pitchRadians),
-			cosf(pitchRadians) * cosf(yawRadians),
-			0.0f
-		);
+			cosf(pitchRadians) * cosf(yawRadians)
+		};
 		return forward;
 	}
-	XMVECTOR GetForward() {
-		float yawRadians = XMConvertToRadians(m_Rotation.x);
+	Vec3 GetForward() const {
+		float yawRadians = Math::ToRadians(m_Rotation.x);
 
-		XMVECTOR forward = XMVectorSet(
+		Vec3 forward{
 			sinf(yawRadians),
 			0.0f,
-			cosf(yawRadians),
-			0.0f
-		);
+			cosf(yawRadians)
+		};
 		return forward;
 	}
 
-	XMFLOAT3 m_Pos{ 0.0f, 0.0f, 0.0f };
-	XMFLOAT3 m_Rotation{ 0.0f, 0.0f, 0.0f };
+	Vec3 m_Pos{ 0.0f, 0.0f, 0.0f };
+	Vec3 m_Rotation{ 0.0f, 0.0f, 0.0f };
 };
\ No newline at end of file
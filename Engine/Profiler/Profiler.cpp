@@ -0,0 +1,206 @@
+#include "Profiler.h"
+#include "Engine/Memory/AllocationTracker.h"
+#include "Util/Log.h"
+#include "Util/Stats.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+	thread_local std::string tlsThreadName{};
+
+	// minimal escaping, zone names are literals but thread names could be anything
+	void WriteJsonString(std::ofstream& out, const std::string& text) {
+		out << '"';
+		for (char c : text) {
+			if (c == '"' || c == '\\') {
+				out << '\\' << c;
+			}
+			else if (static_cast<unsigned char>(c) >= 0x20) {
+				out << c;
+			}
+		}
+		out << '"';
+	}
+}
+
+Profiler::Profiler() {
+	frameTimes.reserve(MaxFrameHistory);
+	frameAllocations.reserve(MaxFrameHistory);
+	sortedFrameTimes.reserve(MaxFrameHistory);
+}
+
+Profiler& Profiler::Get() {
+	static Profiler instance;
+	return instance;
+}
+
+/* frames */
+void Profiler::BeginFrame() {
+	if (capturePending) {
+		StartCapture();
+	}
+	frameStart = Now();
+	frameStartAllocations = AllocationTracker::Allocations();
+}
+
+void Profiler::EndFrame() {
+	const int64_t frameEnd = Now();
+	const float frameMs = static_cast<float>(frameEnd - frameStart) / 1.0e6f;
+	const uint32_t allocations = static_cast<uint32_t>(AllocationTracker::Allocations() - frameStartAllocations);
+	if (frameTimes.size() < MaxFrameHistory) {
+		frameTimes.push_back(frameMs);
+		frameAllocations.push_back(allocations);
+	}
+	else {
+		const size_t oldest = framesRecorded % MaxFrameHistory;
+		frameTimes[oldest] = frameMs;
+		frameAllocations[oldest] = allocations;
+	}
+	++framesRecorded;
+
+	if (!Capturing()) {
+		return;
+	}
+	RecordZone("Frame", frameStart, frameEnd);
+	if (--captureFramesLeft == 0) {
+		StopCapture();
+	}
+}
+
+FrameStats Profiler::GetFrameStats() const {
+	FrameStats stats{};
+	if (frameTimes.empty()) {
+		return stats;
+	}
+
+	std::vector<float>& sorted = sortedFrameTimes;
+	sorted.assign(frameTimes.begin(), frameTimes.end());
+	std::sort(sorted.begin(), sorted.end());
+	float total{ 0.0f };
+	for (float ms : sorted) {
+		total += ms;
+	}
+
+	stats.frames = static_cast<uint32_t>(sorted.size());
+	stats.averageMs = total / static_cast<float>(sorted.size());
+	stats.p50Ms = Percentile(sorted, 50.0f);
+	stats.p95Ms = Percentile(sorted, 95.0f);
+	stats.p99Ms = Percentile(sorted, 99.0f);
+	stats.maxMs = sorted.back();
+
+	uint64_t allocations{ 0 };
+	for (uint32_t count : frameAllocations) {
+		allocations += count;
+		stats.maxAllocations = std::max(stats.maxAllocations, count);
+		stats.allocatingFrames += count > 0 ? 1 : 0;
+	}
+	stats.averageAllocations = static_cast<float>(allocations) / static_cast<float>(frameAllocations.size());
+	return stats;
+}
+
+void Profiler::ResetFrameStats() {
+	frameTimes.clear();
+	frameAllocations.clear();
+	framesRecorded = 0;
+}
+
+/* captures */
+void Profiler::CaptureFrames(uint32_t frameCount, const std::string& path) {
+	if (Capturing() || frameCount == 0) {
+		return;
+	}
+	capturePath = path;
+	captureFramesLeft = frameCount;
+	capturePending = true;
+}
+
+void Profiler::SetThreadName(const char* name) {
+	tlsThreadName = name;
+}
+
+void Profiler::StartCapture() {
+	// nothing records between frames, so the buffers can be reset without racing
+	{
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		for (std::unique_ptr<ThreadBuffer>& buffer : buffers) {
+			buffer->count.store(0, std::memory_order_relaxed);
+			buffer->dropped.store(0, std::memory_order_relaxed);
+		}
+	}
+	capturePending = false;
+	captureStart = Now();
+	Log.info("Profiler capturing " + std::to_string(captureFramesLeft) + " frames");
+	capturing.store(true, std::memory_order_release);
+}
+
+void Profiler::StopCapture() {
+	capturing.store(false, std::memory_order_release);
+	if (WriteTrace(capturePath)) {
+		Log.info("Profiler trace written to " + capturePath);
+	}
+	else {
+		Log.error("Profiler could not write " + capturePath);
+	}
+}
+
+/* recording */
+Profiler::ThreadBuffer& Profiler::LocalBuffer() {
+	thread_local ThreadBuffer* local{ nullptr };
+	if (!local) {
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+		buffer->threadId = static_cast<uint32_t>(buffers.size());
+		buffer->name = tlsThreadName.empty() ? "Thread " + std::to_string(buffer->threadId) : tlsThreadName;
+		buffer->events.resize(EventsPerThread);
+		local = buffer.get();
+		buffers.push_back(std::move(buffer));
+	}
+	return *local;
+}
+
+void Profiler::RecordZone(const char* name, int64_t start, int64_t end) {
+	ThreadBuffer& buffer = LocalBuffer();
+	const uint32_t index = buffer.count.load(std::memory_order_relaxed);
+	if (index >= EventsPerThread) {
+		buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	buffer.events[index] = { name, start, end };
+	buffer.count.store(index + 1, std::memory_order_release);
+}
+
+/* export */
+bool Profiler::WriteTrace(const std::string& path) const {
+	std::ofstream out(path);
+	if (!out.is_open()) {
+		return false;
+	}
+
+	// complete ("X") events with microsecond timestamps relative to the capture start
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first{ true };
+	char line[64]{};
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	for (const std::unique_ptr<ThreadBuffer>& buffer : buffers) {
+		out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":";
+		WriteJsonString(out, buffer->name);
+		out << "}}";
+		first = false;
+
+		const uint32_t count = std::min(buffer->count.load(std::memory_order_acquire), EventsPerThread);
+		for (uint32_t i = 0; i < count; ++i) {
+			const ZoneEvent& event = buffer->events[i];
+			out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"name\":";
+			WriteJsonString(out, event.name);
+			std::snprintf(line, sizeof(line), ",\"ts\":%.3f,\"dur\":%.3f}",
+				static_cast<double>(event.start - captureStart) / 1000.0, static_cast<double>(event.end - event.start) / 1000.0);
+			out << line;
+		}
+		if (buffer->dropped.load(std::memory_order_relaxed) > 0) {
+			Log.warning(buffer->name + " dropped " + std::to_string(buffer->dropped.load(std::memory_order_relaxed)) + " profiler zones");
+		}
+	}
+	out << "\n]}\n";
+	return out.good();
+}
\ No newline at end of file
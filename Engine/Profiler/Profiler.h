@@ -0,0 +1,136 @@
+//
+// Profiler
+// Scoped CPU zones recorded per thread into preallocated buffers, only while a
+// capture is running, so an idle zone costs a single relaxed load
+// Captures are written as Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+// Frame times and heap allocation counts are always kept, so percentiles can
+// be reported next to the FPS
+//
+// Define BUG_DISABLE_PROFILER to compile every zone out
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct FrameStats {
+	uint32_t frames{};
+	float averageMs{};
+	float p50Ms{};
+	float p95Ms{};
+	float p99Ms{};
+	float maxMs{};
+	// heap allocations per frame on all threads, see AllocationTracker
+	float averageAllocations{};
+	uint32_t maxAllocations{};
+	uint32_t allocatingFrames{}; // frames with at least one allocation
+};
+
+class Profiler {
+public:
+	static Profiler& Get();
+
+	static int64_t Now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/* frames, call from the main thread */
+	void BeginFrame();
+	void EndFrame();
+	// frame times since the last reset, at most the latest MaxFrameHistory frames
+	FrameStats GetFrameStats() const;
+	void ResetFrameStats();
+
+	/* captures */
+	// records every zone for the next frameCount frames, then writes them to path
+	void CaptureFrames(uint32_t frameCount, const std::string& path);
+	bool Capturing() const { return capturing.load(std::memory_order_relaxed); }
+
+	// shown as the thread's name in the trace, call from the thread itself
+	static void SetThreadName(const char* name);
+
+	void RecordZone(const char* name, int64_t start, int64_t end);
+private:
+	struct ZoneEvent {
+		const char* name;
+		int64_t start;
+		int64_t end;
+	};
+
+	// written by one thread only, read once the capture stopped
+	struct ThreadBuffer {
+		uint32_t threadId{};
+		std::string name{};
+		std::vector<ZoneEvent> events{};
+		std::atomic<uint32_t> count{ 0 };
+		std::atomic<uint32_t> dropped{ 0 };
+	};
+
+	static constexpr uint32_t EventsPerThread = 1 << 16;
+	static constexpr uint32_t MaxFrameHistory = 1 << 14;
+
+	std::atomic<bool> capturing{ false };
+	mutable std::mutex buffersMutex{};
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers{};
+
+	std::string capturePath{};
+	uint32_t captureFramesLeft{};
+	bool capturePending{ false };
+	int64_t captureStart{};
+
+	int64_t frameStart{};
+	uint64_t frameStartAllocations{};
+	// rings of MaxFrameHistory entries once full, reserved up front so recording never allocates
+	std::vector<float> frameTimes{};
+	std::vector<uint32_t> frameAllocations{};
+	uint64_t framesRecorded{};
+	mutable std::vector<float> sortedFrameTimes{}; // kept so reading the stats does not allocate
+
+	Profiler();
+	~Profiler() = default;
+
+	ThreadBuffer& LocalBuffer();
+	void StartCapture();
+	void StopCapture();
+	bool WriteTrace(const std::string& path) const;
+
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+};
+
+// times the enclosing scope while a capture is running
+class ProfileZone {
+public:
+	explicit ProfileZone(const char* name) {
+		if (Profiler::Get().Capturing()) {
+			this->name = name;
+			start = Profiler::Now();
+		}
+	}
+	~ProfileZone() {
+		if (name) {
+			Profiler::Get().RecordZone(name, start, Profiler::Now());
+		}
+	}
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+private:
+	const char* name{ nullptr };
+	int64_t start{};
+};
+
+#define BUG_PROFILE_CONCAT_INNER(a, b) a##b
+#define BUG_PROFILE_CONCAT(a, b) BUG_PROFILE_CONCAT_INNER(a, b)
+
+#ifndef BUG_DISABLE_PROFILER
+// name must outlive the capture, use string literals
+#define PROFILE_ZONE(name) ProfileZone BUG_PROFILE_CONCAT(profileZone, __LINE__){ name }
+#else
+#define PROFILE_ZONE(name)
+#endif
\ No newline at end of file
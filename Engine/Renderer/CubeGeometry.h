@@ -0,0 +1,41 @@
+//
+// Cube Geometry
+// Built-in unit cube, used when assets/meshes/cube.bmesh cannot be loaded
+// Clockwise winding is front facing
+//
+
+#pragma once
+#include <cstdint>
+#include "Util/Math/Vertices.h"
+
+// pos3 color4
+inline constexpr BasicVertex CubeVertices[8] = {
+	// Front face (z = -0.5)
+	{ { -0.5f, -0.5f, -0.5f }, { 1.0f, 0.0f, 0.0f, 1.0f } }, // Red
+	{ {  0.5f, -0.5f, -0.5f }, { 0.0f, 1.0f, 0.0f, 1.0f } }, // Green
+	{ {  0.5f,  0.5f, -0.5f }, { 0.0f, 0.0f, 1.0f, 1.0f } }, // Blue
+	{ { -0.5f,  0.5f, -0.5f }, { 1.0f, 1.0f, 0.0f, 1.0f } }, // Yellow
+
+	// Back face (z = +0.5)
+	{ { -0.5f, -0.5f,  0.5f }, { 1.0f, 0.0f, 1.0f, 1.0f } }, // Magenta
+	{ {  0.5f, -0.5f,  0.5f }, { 0.0f, 1.0f, 1.0f, 1.0f } }, // Cyan
+	{ {  0.5f,  0.5f,  0.5f }, { 1.0f, 1.0f, 1.0f, 1.0f } }, // White
+	{ { -0.5f,  0.5f,  0.5f }, { 0.0f, 0.0f, 0.0f, 1.0f } }, // Black
+};
+
+inline constexpr uint32_t CubeIndices[36] = {
+	0, 2, 1, // front
+	0, 3, 2,
+
+	5, 7, 4, // back
+	5, 6, 7,
+
+	3, 6, 2, // top
+	3, 7, 6,
+	1, 4, 0, // bottom
+	1, 5, 4,
+	1, 6, 5, // right
+	1, 2, 6,
+	4, 3, 0, // left
+	4, 7, 3
+};
\ No newline at end of file
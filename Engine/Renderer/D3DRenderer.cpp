@@ -1,11 +1,11 @@
 #include "D3DRenderer.h"
 #include "Util/Log.h"
+#include "Engine/Profiler/Profiler.h"
 #include "Util/Math/Vertices.h"
-
-struct ConstantBuffer
-{
-	DirectX::XMMATRIX worldViewProj;
-};
+#include "ShaderCache.h"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
 
 D3DRenderer::~D3DRenderer()
 {
@@ -134,29 +134,6 @@ bool D3DRenderer::Initialize(HWND hWnd, RendererOptions* pRendererOptions) {
 
 
 
-	/* create depth/stencil buffer */
-	{
-		D3D11_TEXTURE2D_DESC dsDesc{};
-		dsDesc.Width = clientWidth;
-		dsDesc.Height = clientHeight;
-		dsDesc.MipLevels = 1;
-		dsDesc.ArraySize = 1;
-		dsDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
-		dsDesc.SampleDesc.Count = 1;
-		dsDesc.SampleDesc.Quality = 0;
-		dsDesc.Usage = D3D11_USAGE_DEFAULT;
-		dsDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
-		dsDesc.CPUAccessFlags = NULL;
-		dsDesc.MiscFlags = NULL;
-
-		// returns HRESULT
-		pDevice->CreateTexture2D(&dsDesc, nullptr, pDepthStencilBuffer.ReleaseAndGetAddressOf());
-		pDevice->CreateDepthStencilView(pDepthStencilBuffer.Get(), nullptr, pDepthStencilView.ReleaseAndGetAddressOf());
-
-		pContext->OMSetRenderTargets(1, pRenderTargetView.GetAddressOf(), pDepthStencilView.Get());
-	}
-
-
 	/* setup viewport */
 	{	// set it to the full client area
 		D3D11_VIEWPORT vp{};
@@ -171,120 +148,22 @@ bool D3DRenderer::Initialize(HWND hWnd, RendererOptions* pRendererOptions) {
 
 
 
-	/* shader compilation */
-	Microsoft::WRL::ComPtr<ID3DBlob> vsBlob{ nullptr };
-	{
-		HRESULT hr = D3DCompileFromFile(TEXT("assets\\shaders\\VertexShader.hlsl"), nullptr, nullptr, "vs_main", "vs_5_0", 0, 0, vsBlob.ReleaseAndGetAddressOf(), nullptr);
-		if (FAILED(hr)) {
-			Log.error("failed to compile shaders from file");
-			return false;
-		}
-
-		hr = pDevice->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, pVertexShader.ReleaseAndGetAddressOf());
-		if (FAILED(hr)) {
-			Log.error("failed to create vertex shader");
-			return false;
-		}
-	}
-	pContext->VSSetShader(pVertexShader.Get(), nullptr, 0);
-
-	Microsoft::WRL::ComPtr<ID3DBlob> psBlob{ nullptr };
-	{
-		HRESULT hr = D3DCompileFromFile(TEXT("assets\\shaders\\PixelShader.hlsl"), nullptr, nullptr, "ps_main", "ps_5_0", 0, 0, psBlob.ReleaseAndGetAddressOf(), nullptr);
-		if (FAILED(hr)) {
-			Log.error("failed to compile shaders from file");
-			return false;
-		}
-
-		hr = pDevice->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, pPixelShader.ReleaseAndGetAddressOf());
-		if (FAILED(hr)) {
-			Log.error("failed to create vertex shader");
-			return false;
-		}
-	}
-	pContext->PSSetShader(pPixelShader.Get(), nullptr, 0);
-
-
-
-	/* setup input layout */
-	D3D11_INPUT_ELEMENT_DESC inputElementDesc[] =
-	{
-		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-		{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 }
-	};
-
-	HRESULT hr = pDevice->CreateInputLayout(inputElementDesc, ARRAYSIZE(inputElementDesc), vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), pInputLayout.ReleaseAndGetAddressOf());
-	if (FAILED(hr)) {
-		Log.error("failed to create input layout");
+	/* shaders and input layout */
+	if (!CompileShaders()) {
 		return false;
 	}
 
-	pContext->IASetInputLayout(pInputLayout.Get());
-
 	/* create static resources */
-
-	// pos3 color4
-	BasicVertex vertexData[] = {
-		{ { -0.5f, -0.5f, -0.5f }, { 1.0f, 0.0f, 0.0f, 1.0f } }, // Red
-		{ {  0.5f, -0.5f, -0.5f }, { 0.0f, 1.0f, 0.0f, 1.0f } }, // Green
-		{ {  0.5f,  0.5f, -0.5f }, { 0.0f, 0.0f, 1.0f, 1.0f } }, // Blue
-		{ { -0.5f,  0.5f, -0.5f }, { 1.0f, 1.0f, 0.0f, 1.0f } }, // Yellow
-
-		// Back face (z = +0.5)
-		{ { -0.5f, -0.5f,  0.5f }, { 1.0f, 0.0f, 1.0f, 1.0f } }, // Magenta
-		{ {  0.5f, -0.5f,  0.5f }, { 0.0f, 1.0f, 1.0f, 1.0f } }, // Cyan
-		{ {  0.5f,  0.5f,  0.5f }, { 1.0f, 1.0f, 1.0f, 1.0f } }, // White
-		{ { -0.5f,  0.5f,  0.5f }, { 0.0f, 0.0f, 0.0f, 1.0f } }, // Black
-	};
-
-	D3D11_BUFFER_DESC vertexBufferDesc{};
-	vertexBufferDesc.ByteWidth = sizeof(vertexData);
-	vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-
-	D3D11_SUBRESOURCE_DATA vertexSubresourceData = { vertexData };
-
-	hr = pDevice->CreateBuffer(&vertexBufferDesc, &vertexSubresourceData, pCubeVertexBuffer.GetAddressOf());
-	if (FAILED(hr)) {
-		Log.error("Failed to create cube vertex buffer");
+	if (!ReserveUploadSpace(UploadBufferSize)) {
+		Log.error("Failed to create upload buffer");
 		return false;
 	}
-
-	UINT stride = sizeof(BasicVertex);
-	UINT offset = 0;
-	pContext->IASetVertexBuffers(0, 1, pCubeVertexBuffer.GetAddressOf(), &stride, &offset);
-
-	UINT indices[36] = {
-		0, 2, 1, // front
-		0, 3, 2,
-
-		5, 7, 4, // back
-		5, 6, 7,
-
-		3, 6, 2, // top
-		3, 7, 6,
-		1, 4, 0, // bottom
-		1, 5, 4,
-		1, 6, 5, // right
-		1, 2, 6,
-		4, 3, 0, // left
-		4, 7, 3
-	};
-
-	D3D11_BUFFER_DESC indexBufferDesc{};
-	indexBufferDesc.ByteWidth = sizeof(indices);
-	indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-
-	D3D11_SUBRESOURCE_DATA indexSubresourceData = { indices };
-
-	hr = pDevice->CreateBuffer(&indexBufferDesc, &indexSubresourceData, pCubeIndexBuffer.ReleaseAndGetAddressOf());
-	if (FAILED(hr)) {
-		Log.error("Failed to create cube index buffer");
+	if (!BuildFrameGraph()) {
+		Log.error("Failed to build the frame graph");
 		return false;
 	}
-
-	pContext->IASetIndexBuffer(pCubeIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+	Log.info("[RenderGraph] " + std::to_string(frameGraph.ExecutedPassCount()) + " of " + std::to_string(frameGraph.PassCount()) + " passes, "
+		+ std::to_string(frameGraph.TransientCount()) + " transient textures in " + std::to_string(frameGraph.PhysicalTextures().size()) + " physical");
 
 	/* setup rasterizer and depth/stencil states */
 
@@ -303,17 +182,8 @@ bool D3DRenderer::Initialize(HWND hWnd, RendererOptions* pRendererOptions) {
 	wire.DepthClipEnable = true;
 	pDevice->CreateRasterizerState1(&wire, pWireframeRSState.ReleaseAndGetAddressOf());
 
-	/* setup to draw */
-
-	D3D11_BUFFER_DESC cbd = {};
-	cbd.Usage = D3D11_USAGE_DEFAULT;
-	cbd.ByteWidth = sizeof(ConstantBuffer);
-	cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	cbd.CPUAccessFlags = 0;
-	pDevice->CreateBuffer(&cbd, nullptr, &pConstantBuffer);
-
-	pContext->RSSetState(pNormalRSState.Get());
-	pContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	// pipeline state is bound lazily through the state cache by the first draw
+	stateCache.Invalidate();
 
 	return true;
 }
@@ -327,6 +197,10 @@ void D3DRenderer::OnResize(int width, int height) {
 	clientHeight = height;
 	// This needs to handle everything on resize, not just the swapchain/backbuffer
 
+	// the swap chain only resizes once nothing references the back buffer
+	pContext->OMSetRenderTargets(0, nullptr, nullptr);
+	stateCache.Invalidate(StateSlot::RenderTarget);
+	stateCache.Invalidate(StateSlot::DepthTarget);
 	pRenderTargetView.Reset(); // let go of backbuffer
 	pSwapChain->ResizeBuffers(0, width, height, DXGI_FORMAT_R8G8B8A8_UNORM, NULL);
 	
@@ -345,6 +219,10 @@ void D3DRenderer::OnResize(int width, int height) {
 	vp.MaxDepth = 1.0f;
 	pContext->RSSetViewports(1, &vp);
 
+	// transient targets follow the back buffer size
+	if (!BuildFrameGraph()) {
+		Log.error("[RenderGraph] rebuilding the frame graph after a resize failed");
+	}
 }
 
 float D3DRenderer::AspectRatio() const {
@@ -353,21 +231,30 @@ float D3DRenderer::AspectRatio() const {
 
 /* drawing */
 
-void D3DRenderer::BeginFrame() {
-	pContext->ClearDepthStencilView(pDepthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-	pContext->OMSetRenderTargets(1, pRenderTargetView.GetAddressOf(), nullptr);
+void D3DRenderer::BeginFrame(const Camera& camera) {
+	viewProj = camera.ViewProj();
+	for (Mesh& mesh : meshes) {
+		for (Lod& lod : mesh.lods) {
+			lod.instances.clear();
+		}
+	}
 }
 
 
 void D3DRenderer::EndFrame() {
+	frameGraph.Execute();
+	stateCache.EndFrame();
+
+	PROFILE_ZONE("Present");
 	pSwapChain->Present(pOpts->vSync ? 1 : 0, 0);
+	// flip model swap chains unbind the back buffer on Present
+	stateCache.Invalidate(StateSlot::RenderTarget);
 }
 
 
 void D3DRenderer::ClearBackground(ColorRGB color) {
-	ColorNorm normalized = color.normalized();
-	// this only works if ColorNorm is the same layout as what ClearRenderTargetView takes (FLOAT[4])
-	pContext->ClearRenderTargetView(pRenderTargetView.Get(), reinterpret_cast<FLOAT*>(&normalized));
+	// cleared at the start of the scene pass
+	clearColor = color.normalized();
 }
 
 void D3DRenderer::DrawRect(Rect rect, ColorRGB color) {
@@ -380,58 +267,383 @@ void D3DRenderer::DrawLine(Vec2 pos, ColorRGB color, float thickness) {
 
 }
 
-void D3DRenderer::DrawCube(PlayerController* pController, Vec3 pos, Vec3 rotation, Vec3 scaling) {
-	using namespace DirectX;
+void D3DRenderer::DrawMesh(MeshHandle mesh, const Mat4& world, uint32_t lod) {
+	if (mesh >= meshes.size() || meshes[mesh].lods.empty()) {
+		return;
+	}
+	std::vector<Lod>& lods = meshes[mesh].lods;
+	lods[std::min<size_t>(lod, lods.size() - 1)].instances.push_back(world);
+}
+
+/* private functions */
+
+// bytecode comes from the shader cache, a warm start does not compile anything
+bool D3DRenderer::CompileShaders() {
+	ShaderCache cache{};
+	Pipeline created{};
+	if (!CreatePipeline(cache, created)) {
+		return false;
+	}
+	SwapPipeline(created);
+
+	if (cache.Misses() > 0) {
+		Log.info("[Shader] " + std::to_string(cache.Misses()) + " shaders were not cached, run with -compile-shaders after changing them");
+	}
+	return true;
+}
+
+// the new pipeline is built next to the old one, a shader that fails to compile leaves the old one in use;
+// shaders whose source did not change come straight from the cache
+bool D3DRenderer::ReloadShader(const std::string& path) {
+	const bool used = std::any_of(std::begin(EngineShaders::All), std::end(EngineShaders::All),
+		[&path](const ShaderDesc* desc) { return path == desc->path; });
+	if (!used) {
+		return true;
+	}
+
+	ShaderCache cache{};
+	Pipeline created{};
+	if (!CreatePipeline(cache, created)) {
+		return false;
+	}
+	SwapPipeline(created);
+	Log.info("[Shader] reloaded " + path + " (" + std::to_string(cache.Misses()) + " compiled, "
+		+ std::to_string(cache.Hits()) + " cached)");
+	return true;
+}
+
+bool D3DRenderer::CreatePipeline(ShaderCache& cache, Pipeline& created) {
+	std::vector<uint8_t> vsBytecode{};
+	if (!cache.Load(EngineShaders::Vertex, vsBytecode)) {
+		return false;
+	}
+	HRESULT hr = pDevice->CreateVertexShader(vsBytecode.data(), vsBytecode.size(), nullptr, created.pVertexShader.GetAddressOf());
+	if (FAILED(hr)) {
+		Log.error("failed to create vertex shader");
+		return false;
+	}
+
+	std::vector<uint8_t> psBytecode{};
+	if (!cache.Load(EngineShaders::Pixel, psBytecode)) {
+		return false;
+	}
+	hr = pDevice->CreatePixelShader(psBytecode.data(), psBytecode.size(), nullptr, created.pPixelShader.GetAddressOf());
+	if (FAILED(hr)) {
+		Log.error("failed to create pixel shader");
+		return false;
+	}
+
+	D3D11_INPUT_ELEMENT_DESC inputElementDesc[] =
+	{
+		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		// worldViewProj, one row per element, from the instance stream in slot 1
+		{ "INSTANCE_TRANSFORM", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		{ "INSTANCE_TRANSFORM", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		{ "INSTANCE_TRANSFORM", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		{ "INSTANCE_TRANSFORM", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+	};
+
+	// one layout per vertex format, only the per vertex elements differ; the shader reads
+	// float3 position and float4 color from either
+	struct LayoutFormats {
+		VertexFormat format;
+		DXGI_FORMAT position;
+		DXGI_FORMAT color;
+		UINT colorOffset;
+	};
+	const LayoutFormats layouts[] = {
+		{ VertexFormat::Basic, DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R32G32B32A32_FLOAT, offsetof(BasicVertex, Color) },
+		{ VertexFormat::Packed, DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R8G8B8A8_UNORM, offsetof(PackedVertex, Color) },
+	};
+	for (const LayoutFormats& layout : layouts) {
+		inputElementDesc[0].Format = layout.position;
+		inputElementDesc[1].Format = layout.color;
+		inputElementDesc[1].AlignedByteOffset = layout.colorOffset;
+		hr = pDevice->CreateInputLayout(inputElementDesc, ARRAYSIZE(inputElementDesc), vsBytecode.data(), vsBytecode.size(),
+			created.pInputLayouts[static_cast<size_t>(layout.format)].GetAddressOf());
+		if (FAILED(hr)) {
+			Log.error("failed to create input layout");
+			return false;
+		}
+	}
+	return true;
+}
+
+// the cache compares raw pointers, the new objects may reuse the addresses of released ones
+void D3DRenderer::SwapPipeline(Pipeline& created) {
+	std::swap(pipeline, created);
+	stateCache.Invalidate(StateSlot::VertexShader);
+	stateCache.Invalidate(StateSlot::PixelShader);
+	stateCache.Invalidate(StateSlot::InputLayout);
+}
 
-	XMMATRIX S = XMMatrixScaling(scaling.x, scaling.y, scaling.z);
-	XMMATRIX R = XMMatrixRotationRollPitchYaw(rotation.x, rotation.y, rotation.z);
-	XMMATRIX T = XMMatrixTranslation(pos.x, pos.y, pos.z);
-	XMMATRIX SRT = S * R * T;
-	XMStoreFloat4x4(&mWorld, SRT);
+MeshHandle D3DRenderer::CreateMesh(const MeshData& data) {
+	Mesh mesh{};
+	if (!CreateMeshBuffers(mesh, data)) {
+		return InvalidMesh;
+	}
 
-	XMMATRIX projec = XMMatrixPerspectiveFovLH(XM_PIDIV4, AspectRatio(), 0.1f, 1000.0f);
-	XMStoreFloat4x4(&mProj, projec);
+	meshes.push_back(std::move(mesh));
+	return static_cast<MeshHandle>(meshes.size() - 1);
+}
 
-	XMVECTOR position = XMVectorSet(pController->m_Pos.x, pController->m_Pos.y, pController->m_Pos.z, 1.0f);
+bool D3DRenderer::UpdateMesh(MeshHandle mesh, const MeshData& data) {
+	if (mesh >= meshes.size()) {
+		return false;
+	}
+	// the buffers are immutable, so build new ones and keep the old ones if that fails
+	Mesh replacement{};
+	if (!CreateMeshBuffers(replacement, data)) {
+		return false;
+	}
 
-	XMVECTOR target = XMVectorAdd(position, pController->GetView());
-	XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+	Mesh& m = meshes[mesh];
+	m.pVertexBuffer = std::move(replacement.pVertexBuffer);
+	m.pIndexBuffer = std::move(replacement.pIndexBuffer);
+	m.indexFormat = replacement.indexFormat;
+	m.vertexFormat = replacement.vertexFormat;
+	// the level count may change, instances already queued this frame are dropped
+	m.lods = std::move(replacement.lods);
+	return true;
+}
 
-	XMMATRIX V = XMMatrixLookAtLH(position, target, up);
-	XMStoreFloat4x4(&mView, V);
+void D3DRenderer::DestroyMesh(MeshHandle mesh) {
+	if (mesh >= meshes.size()) {
+		return;
+	}
+	Mesh& m = meshes[mesh];
+	m.pVertexBuffer.Reset();
+	m.pIndexBuffer.Reset();
+	m.lods.clear();
+}
 
-	XMMATRIX world = XMLoadFloat4x4(&mWorld);
-	XMMATRIX view = XMLoadFloat4x4(&mView);
-	XMMATRIX proj = XMLoadFloat4x4(&mProj);
-	XMMATRIX worldViewProj = world * view * proj;
+// a single scene pass for now, shadow, post and UI passes declare their targets here
+bool D3DRenderer::BuildFrameGraph() {
+	const UINT width = std::max(clientWidth, 1u);
+	const UINT height = std::max(clientHeight, 1u);
 
-	ConstantBuffer cb{};
-	cb.worldViewProj = XMMatrixTranspose(worldViewProj); // Transpose before sending
+	frameGraph.Reset();
+	backBuffer = frameGraph.ImportTexture("Back Buffer", { width, height, TextureFormat::RGBA8 });
+	sceneDepth = frameGraph.CreateTexture("Scene Depth", { width, height, TextureFormat::Depth24Stencil8 });
+	frameGraph.AddPass("Scene", [this](const RenderGraph&) { ExecuteScenePass(); })
+		.Write(backBuffer)
+		.Write(sceneDepth);
 
-	pContext->IASetInputLayout(pInputLayout.Get());
-	pContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	if (!frameGraph.Compile()) {
+		return false;
+	}
+	return CreateGraphTextures();
+}
 
-	UINT stride = sizeof(BasicVertex);
-	UINT offset = 0;
-	pContext->IASetVertexBuffers(0, 1, pCubeVertexBuffer.GetAddressOf(), &stride, &offset);
-	pContext->IASetIndexBuffer(pCubeIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-	pContext->UpdateSubresource(pConstantBuffer.Get(), 0, nullptr, &cb, 0, 0);
-	pContext->VSSetConstantBuffers(0, 1, pConstantBuffer.GetAddressOf());
+// only physical textures whose description changed are recreated
+bool D3DRenderer::CreateGraphTextures() {
+	const std::vector<TextureDesc>& physical = frameGraph.PhysicalTextures();
+	graphTextures.resize(physical.size());
+	for (size_t i = 0; i < physical.size(); ++i) {
+		GraphTexture& texture = graphTextures[i];
+		if (texture.pTexture && texture.desc == physical[i]) {
+			continue;
+		}
+		texture = GraphTexture{};
+		texture.desc = physical[i];
+
+		const bool depth = texture.desc.format == TextureFormat::Depth24Stencil8;
+		D3D11_TEXTURE2D_DESC desc{};
+		desc.Width = texture.desc.width;
+		desc.Height = texture.desc.height;
+		desc.MipLevels = 1;
+		desc.ArraySize = 1;
+		desc.Format = depth ? DXGI_FORMAT_D24_UNORM_S8_UINT
+			: texture.desc.format == TextureFormat::RGBA16F ? DXGI_FORMAT_R16G16B16A16_FLOAT : DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.SampleDesc.Count = 1;
+		desc.Usage = D3D11_USAGE_DEFAULT;
+		desc.BindFlags = depth ? D3D11_BIND_DEPTH_STENCIL : D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+
+		HRESULT hr = pDevice->CreateTexture2D(&desc, nullptr, texture.pTexture.ReleaseAndGetAddressOf());
+		if (SUCCEEDED(hr)) {
+			hr = depth ? pDevice->CreateDepthStencilView(texture.pTexture.Get(), nullptr, texture.pDepthStencilView.ReleaseAndGetAddressOf())
+				: pDevice->CreateRenderTargetView(texture.pTexture.Get(), nullptr, texture.pRenderTargetView.ReleaseAndGetAddressOf());
+		}
+		if (FAILED(hr)) {
+			Log.error("[RenderGraph] creating a " + std::to_string(desc.Width) + "x" + std::to_string(desc.Height) + " target failed");
+			texture = GraphTexture{};
+			return false;
+		}
+	}
+	return true;
+}
 
+void D3DRenderer::ExecuteScenePass() {
+	ID3D11RenderTargetView* renderTarget = pRenderTargetView.Get();
+	ID3D11DepthStencilView* depthTarget = graphTextures[frameGraph.Physical(sceneDepth)].pDepthStencilView.Get();
+	// not short-circuited, both slots have to be updated
+	if (stateCache.Bind(StateSlot::RenderTarget, renderTarget) | stateCache.Bind(StateSlot::DepthTarget, depthTarget)) {
+		pContext->OMSetRenderTargets(1, &renderTarget, depthTarget);
+	}
+	// this only works if ColorNorm is the same layout as what ClearRenderTargetView takes (FLOAT[4])
+	pContext->ClearRenderTargetView(renderTarget, reinterpret_cast<const FLOAT*>(&clearColor));
+	pContext->ClearDepthStencilView(depthTarget, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 
-	pContext->DrawIndexed(36, 0, 0);
+	FlushInstances();
 }
 
-/* private functions */
+// uploaded in the stored format, the input layout and index format are picked per mesh when drawing
+bool D3DRenderer::CreateMeshBuffers(Mesh& mesh, const MeshData& data) {
+	mesh.lods.resize(data.LodCount());
+	for (uint32_t level = 0; level < data.LodCount(); ++level) {
+		const MeshLod lod = data.Lod(level);
+		mesh.lods[level].firstIndex = lod.firstIndex;
+		mesh.lods[level].indexCount = lod.indexCount;
+	}
+	mesh.indexFormat = data.indexSize == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	mesh.vertexFormat = data.vertexFormat;
 
-bool D3DRenderer::CompileShaders() {
-	// REDO THIS LATER
+	D3D11_BUFFER_DESC vertexBufferDesc{};
+	vertexBufferDesc.ByteWidth = data.VertexBytes();
+	vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 
+	D3D11_SUBRESOURCE_DATA vertexSubresourceData = { data.vertices };
 
+	HRESULT hr = pDevice->CreateBuffer(&vertexBufferDesc, &vertexSubresourceData, mesh.pVertexBuffer.ReleaseAndGetAddressOf());
+	if (FAILED(hr)) {
+		Log.error("[Mesh] vertex buffer creation failed");
+		return false;
+	}
 
-	{
+	D3D11_BUFFER_DESC indexBufferDesc{};
+	indexBufferDesc.ByteWidth = data.IndexBytes();
+	indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+	D3D11_SUBRESOURCE_DATA indexSubresourceData = { data.indices };
+
+	hr = pDevice->CreateBuffer(&indexBufferDesc, &indexSubresourceData, mesh.pIndexBuffer.ReleaseAndGetAddressOf());
+	if (FAILED(hr)) {
+		Log.error("[Mesh] index buffer creation failed");
+		return false;
+	}
+	return true;
+}
+
+bool D3DRenderer::ReserveUploadSpace(size_t size) {
+	if (pUploadBuffer && size <= uploadRing.Capacity()) {
+		return true;
+	}
+
+	// only a frame bigger than the whole ring recreates it
+	const size_t capacity = std::max({ size, UploadBufferSize, uploadRing.Capacity() * 2 });
 
+	D3D11_BUFFER_DESC desc{};
+	desc.ByteWidth = static_cast<UINT>(capacity);
+	desc.Usage = D3D11_USAGE_DYNAMIC;
+	desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+	HRESULT hr = pDevice->CreateBuffer(&desc, nullptr, pUploadBuffer.ReleaseAndGetAddressOf());
+	if (FAILED(hr)) {
+		Log.error("[Upload] pDevice->CreateBuffer() failed");
+		uploadRing.Reset(0);
+		return false;
 	}
 
+	uploadRing.Reset(capacity);
 	return true;
+}
+
+void D3DRenderer::FlushInstances() {
+	PROFILE_ZONE("Flush Instances");
+	UINT totalInstances = 0;
+	for (const Mesh& mesh : meshes) {
+		for (const Lod& lod : mesh.lods) {
+			totalInstances += static_cast<UINT>(lod.instances.size());
+		}
+	}
+	const size_t size = totalInstances * sizeof(Mat4);
+	if (totalInstances == 0 || !ReserveUploadSpace(size)) {
+		return;
+	}
+
+	size_t offset = uploadRing.Allocate(size, sizeof(Mat4));
+	if (offset == UploadRing::InvalidOffset) {
+		// the GPU may still read any earlier slice, discarding has the driver hand out fresh memory
+		uploadRing.Discard();
+		offset = uploadRing.Allocate(size, sizeof(Mat4));
+	}
+	// offset 0 is the first slice since the buffer was created or discarded, later slices only append
+	const D3D11_MAP mapType = offset == 0 ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+
+	// pack every mesh's instances back to back, one upload for the whole frame
+	D3D11_MAPPED_SUBRESOURCE mapped{};
+	if (FAILED(pContext->Map(pUploadBuffer.Get(), 0, mapType, 0, &mapped))) {
+		Log.error("[Upload] pContext->Map() failed");
+		return;
+	}
+	// world * viewProj for every instance as one batch, written straight into the mapped slice;
+	// every level of a mesh with instances becomes one batch
+	batches.clear();
+	Mat4* dst = reinterpret_cast<Mat4*>(static_cast<uint8_t*>(mapped.pData) + offset);
+	UINT firstInstance = 0;
+	for (MeshHandle handle = 0; handle < meshes.size(); ++handle) {
+		const Mesh& mesh = meshes[handle];
+		for (uint32_t level = 0; level < mesh.lods.size(); ++level) {
+			const Lod& lod = mesh.lods[level];
+			if (lod.instances.empty()) {
+				continue;
+			}
+			MultiplyBatch(lod.instances.data(), lod.instances.size(), viewProj, dst);
+			dst += lod.instances.size();
+
+			const UINT instanceCount = static_cast<UINT>(lod.instances.size());
+			// meshes sharing an input layout are drawn together, levels of one mesh share its buffers
+			batches.push_back({ DrawKey::Make(static_cast<uint32_t>(mesh.vertexFormat), 0, handle, level), firstInstance, instanceCount });
+			firstInstance += instanceCount;
+		}
+	}
+	pContext->Unmap(pUploadBuffer.Get(), 0);
+
+	std::sort(batches.begin(), batches.end(), [](const Batch& a, const Batch& b) { return a.key < b.key; });
+
+	for (const Batch& batch : batches) {
+		const Mesh& mesh = meshes[DrawKey::Mesh(batch.key)];
+		const Lod& lod = mesh.lods[DrawKey::Lod(batch.key)];
+
+		if (stateCache.Bind(StateSlot::VertexShader, pipeline.pVertexShader.Get())) {
+			pContext->VSSetShader(pipeline.pVertexShader.Get(), nullptr, 0);
+		}
+		if (stateCache.Bind(StateSlot::PixelShader, pipeline.pPixelShader.Get())) {
+			pContext->PSSetShader(pipeline.pPixelShader.Get(), nullptr, 0);
+		}
+		ID3D11InputLayout* inputLayout = pipeline.pInputLayouts[static_cast<size_t>(mesh.vertexFormat)].Get();
+		if (stateCache.Bind(StateSlot::InputLayout, inputLayout)) {
+			pContext->IASetInputLayout(inputLayout);
+		}
+		if (stateCache.Bind(StateSlot::Topology, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST)) {
+			pContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		}
+		if (stateCache.Bind(StateSlot::Rasterizer, pNormalRSState.Get())) {
+			pContext->RSSetState(pNormalRSState.Get());
+		}
+
+		if (stateCache.Bind(StateSlot::VertexBuffer, mesh.pVertexBuffer.Get())) {
+			ID3D11Buffer* buffer = mesh.pVertexBuffer.Get();
+			const UINT stride = VertexStride(mesh.vertexFormat);
+			const UINT vertexOffset = 0;
+			pContext->IASetVertexBuffers(0, 1, &buffer, &stride, &vertexOffset);
+		}
+		// not short-circuited, both slots have to be updated
+		if (stateCache.Bind(StateSlot::InstanceBuffer, pUploadBuffer.Get()) | stateCache.Bind(StateSlot::InstanceOffset, offset)) {
+			ID3D11Buffer* buffer = pUploadBuffer.Get();
+			const UINT stride = sizeof(Mat4);
+			const UINT instanceOffset = static_cast<UINT>(offset);
+			pContext->IASetVertexBuffers(1, 1, &buffer, &stride, &instanceOffset);
+		}
+		if (stateCache.Bind(StateSlot::IndexBuffer, mesh.pIndexBuffer.Get())) {
+			pContext->IASetIndexBuffer(mesh.pIndexBuffer.Get(), mesh.indexFormat, 0);
+		}
+
+		pContext->DrawIndexedInstanced(lod.indexCount, batch.instanceCount, lod.firstIndex, 0, batch.firstInstance);
+		stateCache.CountDraw(lod.indexCount / 3 * batch.instanceCount);
+	}
 }
\ No newline at end of file
@@ -6,14 +6,17 @@
 
 #pragma once
 #include "IRenderer.h"
+#include "StateCache.h"
+#include "UploadRing.h"
+#include "RenderGraph.h"
 #include <d3d11_1.h>
 #pragma comment(lib, "d3d11.lib")
-#include <DirectXMath.h>
-#include <DirectXPackedVector.h>
-#include <d3dcompiler.h>
-#pragma comment(lib, "d3dcompiler.lib")
 #include <wrl.h>
-#include "Engine/PlayerController.h"
+#include <string>
+#include <vector>
+#include "Util/Math/Vertices.h"
+
+class ShaderCache;
 
 class D3DRenderer : public IRenderer {
 public:
@@ -22,12 +25,17 @@ public:
 
 	bool Initialize(HWND hWnd, RendererOptions* pRendererOptions) override;
 	bool CompileShaders() override;
+	bool ReloadShader(const std::string& path) override;
 	void Shutdown() override;
 	void OnResize(int width, int height) override;
 
 	float AspectRatio() const override;
+
+	MeshHandle CreateMesh(const MeshData& data) override;
+	bool UpdateMesh(MeshHandle mesh, const MeshData& data) override;
+	void DestroyMesh(MeshHandle mesh) override;
 	
-	void BeginFrame() override;
+	void BeginFrame(const Camera& camera) override;
 	void EndFrame() override;
 
 	void ClearBackground(ColorRGB color) override;
@@ -35,11 +43,14 @@ public:
 	void DrawFilledRect(Rect rect, ColorRGB color, float thickness) override;
 	void DrawLine(Vec2 pos, ColorRGB color, float thickness) override;
 
-	void DrawCube(PlayerController* pController, Vec3 pos, Vec3 rotation, Vec3 scaling) override;
+	void DrawMesh(MeshHandle mesh, const Mat4& world, uint32_t lod) override;
+
+	RenderStats GetRenderStats() const override { return stateCache.LastFrame(); }
 private:
 	HWND hWnd{};
 	UINT clientWidth{}, clientHeight{};
 	RendererOptions* pOpts{ nullptr };
+	Mat4 viewProj{}; // captured from the camera in BeginFrame
 
 	Microsoft::WRL::ComPtr<ID3D11Device1> pDevice{ nullptr };
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext1> pContext{ nullptr };
@@ -49,20 +60,64 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11RasterizerState1> pNormalRSState{ nullptr };
 	Microsoft::WRL::ComPtr<ID3D11RasterizerState1> pWireframeRSState{ nullptr };
 
-	Microsoft::WRL::ComPtr<ID3D11Texture2D> pDepthStencilBuffer{ nullptr };
-	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> pDepthStencilView{ nullptr };
+	// passes of a frame, rebuilt when the back buffer is resized; the depth buffer and every
+	// other intermediate target is a transient texture of the graph
+	RenderGraph frameGraph{};
+	RenderResource backBuffer{ InvalidResource };
+	RenderResource sceneDepth{ InvalidResource };
+	struct GraphTexture {
+		TextureDesc desc{};
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> pTexture{ nullptr };
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> pRenderTargetView{ nullptr };
+		Microsoft::WRL::ComPtr<ID3D11DepthStencilView> pDepthStencilView{ nullptr };
+	};
+	std::vector<GraphTexture> graphTextures{}; // indexed by physical texture, kept across rebuilds
+	ColorNorm clearColor{ 0.0f, 0.0f, 0.0f, 1.0f };
+
+	// replaced as a whole, so a frame never draws with shaders from different builds
+	struct Pipeline {
+		Microsoft::WRL::ComPtr<ID3D11VertexShader> pVertexShader{ nullptr };
+		Microsoft::WRL::ComPtr<ID3D11PixelShader> pPixelShader{ nullptr };
+		Microsoft::WRL::ComPtr<ID3D11InputLayout> pInputLayouts[2]{}; // indexed by VertexFormat
+	};
+	Pipeline pipeline{};
 
-	Microsoft::WRL::ComPtr<ID3D11VertexShader> pVertexShader{ nullptr };
-	Microsoft::WRL::ComPtr<ID3D11PixelShader> pPixelShader{ nullptr };
-	Microsoft::WRL::ComPtr<ID3D11InputLayout> pInputLayout{ nullptr };
+	// index range of one level of detail, all levels share the mesh's buffers
+	struct Lod {
+		UINT firstIndex{};
+		UINT indexCount{};
+		std::vector<Mat4> instances{}; // world matrix of every instance queued this frame
+	};
+	struct Mesh {
+		Microsoft::WRL::ComPtr<ID3D11Buffer> pVertexBuffer{ nullptr };
+		Microsoft::WRL::ComPtr<ID3D11Buffer> pIndexBuffer{ nullptr };
+		DXGI_FORMAT indexFormat{ DXGI_FORMAT_R32_UINT };
+		VertexFormat vertexFormat{ VertexFormat::Basic };
+		std::vector<Lod> lods{}; // finest first, empty once destroyed
+	};
+	std::vector<Mesh> meshes{}; // indexed by MeshHandle
 
-	Microsoft::WRL::ComPtr<ID3D11Buffer> pCubeVertexBuffer{ nullptr };
-	Microsoft::WRL::ComPtr<ID3D11Buffer> pCubeIndexBuffer{ nullptr };
+	// per instance data of every frame is appended to one persistent dynamic buffer,
+	// mapped with NO_OVERWRITE until it is full and then with DISCARD
+	static constexpr size_t UploadBufferSize = 4 << 20;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> pUploadBuffer{ nullptr };
+	UploadRing uploadRing{};
 
-	Microsoft::WRL::ComPtr<ID3D11Buffer> pConstantBuffer{ nullptr };
+	// one instanced draw, built in FlushInstances and drawn in key order
+	struct Batch {
+		uint64_t key;
+		UINT firstInstance;
+		UINT instanceCount;
+	};
+	std::vector<Batch> batches{};
+	StateCache stateCache{};
 
-	DirectX::XMMATRIX gWorldViewProj{};
-	DirectX::XMFLOAT4X4 mWorld{};
-	DirectX::XMFLOAT4X4 mView{};
-	DirectX::XMFLOAT4X4 mProj{};
+	bool CreatePipeline(ShaderCache& cache, Pipeline& created);
+	void SwapPipeline(Pipeline& created);
+	bool BuildFrameGraph();
+	bool CreateGraphTextures();
+	void ExecuteScenePass();
+	bool CreateMeshBuffers(Mesh& mesh, const MeshData& data);
+	bool ReserveUploadSpace(size_t size);
+	void FlushInstances();
 };
\ No newline at end of file
@@ -3,28 +3,64 @@
 // 
 
 #pragma once
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include "Util/Color.h"
 #include "Util/Types.h"
 #include "Util/Math/Vectors.h"
 #include "Util/Math/Mat4.h"
+#include "Util/Math/Vertices.h"
 #include "RendererOptions.h"
-#include "Engine/PlayerController.h"
+#include "Engine/Camera.h"
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+using NativeWindow = HWND;
+#else
+using NativeWindow = void*;
+#endif
+
+// index of a mesh registered with the renderer
+using MeshHandle = uint32_t;
+inline constexpr MeshHandle InvalidMesh = UINT32_MAX;
+
+// pipeline work of one frame, redundant binds are the ones the state cache filtered out
+struct RenderStats {
+	uint32_t draws{};
+	uint32_t triangles{};
+	uint32_t binds{};
+	uint32_t redundantBinds{};
+};
 
 class IRenderer {
 public:
 	/* general */
 	virtual ~IRenderer() = default;
 
-	virtual bool Initialize(HWND hWnd, RendererOptions* pRendererOptions) = 0;
+	// hWnd is null when running headless
+	virtual bool Initialize(NativeWindow hWnd, RendererOptions* pRendererOptions) = 0;
 	virtual bool CompileShaders() = 0;
+	// rebuilds the pipelines that use the shader source at path between frames, the renderer must be idle;
+	// false if it fails to compile, the previous pipelines stay in use then
+	virtual bool ReloadShader(const std::string& path) { return true; }
 	virtual void Shutdown() = 0;
 	virtual void OnResize(int width, int height) = 0;
 
 	virtual float AspectRatio() const = 0;
 
+	/* resources */
+	// the data is only read during the call, so it can point into a mapped file
+	virtual MeshHandle CreateMesh(const MeshData& data) = 0;
+	// replaces the geometry behind a handle, e.g. a streamed asset taking over from its placeholder
+	virtual bool UpdateMesh(MeshHandle mesh, const MeshData& data) = 0;
+	// frees the geometry, drawing the handle afterwards draws nothing
+	virtual void DestroyMesh(MeshHandle mesh) = 0;
+
 	/* drawing */
-	virtual void BeginFrame() = 0;
+	// the camera's matrices are captured for the whole frame
+	virtual void BeginFrame(const Camera& camera) = 0;
 	virtual void EndFrame() = 0;
 
 	virtual void ClearBackground(ColorRGB color) = 0;
@@ -32,5 +68,11 @@ public:
 	virtual void DrawFilledRect(Rect rect, ColorRGB color, float thickness) = 0;
 	virtual void DrawLine(Vec2 pos, ColorRGB color, float thickness) = 0;
 
-	virtual void DrawCube(PlayerController* pController, Vec3 pos, Vec3 rotation, Vec3 scaling) = 0;
+	// queues one instance of a level of detail of mesh (clamped to its coarsest), every instance
+	// of a level is submitted with a single draw in EndFrame
+	virtual void DrawMesh(MeshHandle mesh, const Mat4& world, uint32_t lod) = 0;
+
+	/* stats */
+	// counts of the last finished frame, callable from any thread; backends without pipeline state report zeros
+	virtual RenderStats GetRenderStats() const { return {}; }
 };
\ No newline at end of file
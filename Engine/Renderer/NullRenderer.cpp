@@ -0,0 +1,162 @@
+#include "NullRenderer.h"
+#include "Util/Log.h"
+#include "Engine/Profiler/Profiler.h"
+#include <algorithm>
+
+NullRenderer::~NullRenderer()
+{
+}
+
+bool NullRenderer::Initialize(NativeWindow hWnd, RendererOptions* pRendererOptions) {
+	Log.info("Initializing null renderer...");
+	this->pOpts = pRendererOptions;
+	clientWidth = pRendererOptions->width;
+	clientHeight = pRendererOptions->height;
+	if (!BuildFrameGraph()) {
+		Log.error("Failed to build the frame graph");
+		return false;
+	}
+	Log.info("[RenderGraph] " + std::to_string(frameGraph.ExecutedPassCount()) + " of " + std::to_string(frameGraph.PassCount()) + " passes, "
+		+ std::to_string(frameGraph.TransientCount()) + " transient textures in " + std::to_string(frameGraph.PhysicalTextures().size()) + " physical");
+	return true;
+}
+
+bool NullRenderer::CompileShaders() {
+	return true;
+}
+
+void NullRenderer::Shutdown() {
+
+}
+
+void NullRenderer::OnResize(int width, int height) {
+	clientWidth = width;
+	clientHeight = height;
+	if (!BuildFrameGraph()) {
+		Log.error("[RenderGraph] rebuilding the frame graph after a resize failed");
+	}
+}
+
+float NullRenderer::AspectRatio() const {
+	return static_cast<float>(clientWidth) / static_cast<float>(clientHeight);
+}
+
+MeshHandle NullRenderer::CreateMesh(const MeshData& data) {
+	meshLods.emplace_back();
+	UpdateMesh(static_cast<MeshHandle>(meshLods.size() - 1), data);
+	return static_cast<MeshHandle>(meshLods.size() - 1);
+}
+
+bool NullRenderer::UpdateMesh(MeshHandle mesh, const MeshData& data) {
+	if (mesh >= meshLods.size()) {
+		return false;
+	}
+	// nothing to upload, only the level sizes and instance streams are kept
+	std::vector<Lod>& lods = meshLods[mesh];
+	lods.assign(data.LodCount(), Lod{});
+	for (uint32_t level = 0; level < data.LodCount(); ++level) {
+		lods[level].triangles = data.Lod(level).indexCount / 3;
+	}
+	return true;
+}
+
+void NullRenderer::DestroyMesh(MeshHandle mesh) {
+	if (mesh < meshLods.size()) {
+		meshLods[mesh].clear();
+	}
+}
+
+/* drawing */
+
+void NullRenderer::BeginFrame(const Camera& camera) {
+	viewProj = camera.ViewProj();
+	for (std::vector<Lod>& lods : meshLods) {
+		for (Lod& lod : lods) {
+			lod.instances.clear();
+		}
+	}
+}
+
+void NullRenderer::EndFrame() {
+	PROFILE_ZONE("Null EndFrame");
+	frameGraph.Execute();
+	stateCache.EndFrame();
+}
+
+bool NullRenderer::BuildFrameGraph() {
+	const uint32_t width = static_cast<uint32_t>(std::max(clientWidth, 1));
+	const uint32_t height = static_cast<uint32_t>(std::max(clientHeight, 1));
+
+	frameGraph.Reset();
+	backBuffer = frameGraph.ImportTexture("Back Buffer", { width, height, TextureFormat::RGBA8 });
+	sceneDepth = frameGraph.CreateTexture("Scene Depth", { width, height, TextureFormat::Depth24Stencil8 });
+	frameGraph.AddPass("Scene", [this](const RenderGraph&) { ExecuteScenePass(); })
+		.Write(backBuffer)
+		.Write(sceneDepth);
+	return frameGraph.Compile();
+}
+
+void NullRenderer::ExecuteScenePass() {
+	stateCache.Bind(StateSlot::RenderTarget, uint64_t{ 1 });
+	stateCache.Bind(StateSlot::DepthTarget, uint64_t{ frameGraph.Physical(sceneDepth) });
+
+	size_t totalInstances = 0;
+	for (const std::vector<Lod>& lods : meshLods) {
+		for (const Lod& lod : lods) {
+			totalInstances += lod.instances.size();
+		}
+	}
+	uploadBuffer.resize(totalInstances);
+
+	batchKeys.clear();
+	Mat4* dst = uploadBuffer.data();
+	for (MeshHandle handle = 0; handle < meshLods.size(); ++handle) {
+		const std::vector<Lod>& lods = meshLods[handle];
+		for (uint32_t level = 0; level < lods.size(); ++level) {
+			const std::vector<Mat4>& instances = lods[level].instances;
+			if (instances.empty()) {
+				continue;
+			}
+			MultiplyBatch(instances.data(), instances.size(), viewProj, dst);
+			dst += instances.size();
+			batchKeys.push_back(DrawKey::Make(0, 0, handle, level));
+		}
+	}
+
+	std::sort(batchKeys.begin(), batchKeys.end());
+	for (uint64_t key : batchKeys) {
+		const MeshHandle mesh = DrawKey::Mesh(key);
+		const Lod& lod = meshLods[mesh][DrawKey::Lod(key)];
+		stateCache.Bind(StateSlot::VertexShader, uint64_t{ 1 });
+		stateCache.Bind(StateSlot::PixelShader, uint64_t{ 1 });
+		stateCache.Bind(StateSlot::InputLayout, uint64_t{ 1 });
+		stateCache.Bind(StateSlot::Topology, uint64_t{ 1 });
+		stateCache.Bind(StateSlot::Rasterizer, uint64_t{ 1 });
+		stateCache.Bind(StateSlot::VertexBuffer, mesh);
+		stateCache.Bind(StateSlot::InstanceBuffer, uint64_t{ 1 });
+		stateCache.Bind(StateSlot::IndexBuffer, mesh);
+		stateCache.CountDraw(lod.triangles * static_cast<uint32_t>(lod.instances.size()));
+	}
+}
+
+void NullRenderer::ClearBackground(ColorRGB color) {
+
+}
+
+void NullRenderer::DrawRect(Rect rect, ColorRGB color) {
+
+}
+void NullRenderer::DrawFilledRect(Rect rect, ColorRGB color, float thickness) {
+
+}
+void NullRenderer::DrawLine(Vec2 pos, ColorRGB color, float thickness) {
+
+}
+
+void NullRenderer::DrawMesh(MeshHandle mesh, const Mat4& world, uint32_t lod) {
+	if (mesh >= meshLods.size() || meshLods[mesh].empty()) {
+		return;
+	}
+	std::vector<Lod>& lods = meshLods[mesh];
+	lods[std::min<size_t>(lod, lods.size() - 1)].instances.push_back(world);
+}
\ No newline at end of file
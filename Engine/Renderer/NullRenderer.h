@@ -0,0 +1,66 @@
+//
+// Null Renderer
+// Performs the same per-frame CPU work as the other backends
+// (transforms, constant data) without a GPU, window or presentation
+// Used for headless benchmark runs
+//
+
+#pragma once
+#include "IRenderer.h"
+#include "StateCache.h"
+#include "RenderGraph.h"
+#include <cstdint>
+#include <vector>
+
+class NullRenderer : public IRenderer {
+public:
+	NullRenderer() = default;
+	~NullRenderer() override;
+
+	bool Initialize(NativeWindow hWnd, RendererOptions* pRendererOptions) override;
+	bool CompileShaders() override;
+	void Shutdown() override;
+	void OnResize(int width, int height) override;
+
+	float AspectRatio() const override;
+
+	MeshHandle CreateMesh(const MeshData& data) override;
+	bool UpdateMesh(MeshHandle mesh, const MeshData& data) override;
+	void DestroyMesh(MeshHandle mesh) override;
+
+	void BeginFrame(const Camera& camera) override;
+	void EndFrame() override;
+
+	void ClearBackground(ColorRGB color) override;
+	void DrawRect(Rect rect, ColorRGB color) override;
+	void DrawFilledRect(Rect rect, ColorRGB color, float thickness) override;
+	void DrawLine(Vec2 pos, ColorRGB color, float thickness) override;
+
+	void DrawMesh(MeshHandle mesh, const Mat4& world, uint32_t lod) override;
+
+	RenderStats GetRenderStats() const override { return stateCache.LastFrame(); }
+private:
+	int clientWidth{}, clientHeight{};
+	RendererOptions* pOpts{ nullptr };
+	Mat4 viewProj{}; // captured from the camera in BeginFrame
+
+	// per-level world matrices, multiplied by viewProj into uploadBuffer in EndFrame like the D3D instance buffer
+	struct Lod {
+		uint32_t triangles{};
+		std::vector<Mat4> instances{};
+	};
+	std::vector<std::vector<Lod>> meshLods{}; // indexed by MeshHandle, finest level first
+	std::vector<Mat4> uploadBuffer{};
+
+	// batches are sorted and bound through the state cache like on D3D, mesh handles stand in for buffers
+	std::vector<uint64_t> batchKeys{};
+	StateCache stateCache{};
+
+	// same passes as D3D, physical texture indices stand in for the targets
+	RenderGraph frameGraph{};
+	RenderResource backBuffer{ InvalidResource };
+	RenderResource sceneDepth{ InvalidResource };
+
+	bool BuildFrameGraph();
+	void ExecuteScenePass();
+};
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "RenderGraph.h"
+#include "Util/Log.h"
+#include "Engine/Profiler/Profiler.h"
+#include <algorithm>
+#include <string>
+
+namespace {
+	constexpr uint32_t NoPass = UINT32_MAX;
+}
+
+/* declaration */
+
+RenderPassBuilder& RenderPassBuilder::Read(RenderResource resource) {
+	graph.AddAccess(pass, resource, false);
+	return *this;
+}
+
+RenderPassBuilder& RenderPassBuilder::Write(RenderResource resource) {
+	graph.AddAccess(pass, resource, true);
+	return *this;
+}
+
+RenderPassBuilder& RenderPassBuilder::SideEffect() {
+	graph.passes[pass].sideEffect = true;
+	return *this;
+}
+
+void RenderGraph::Reset() {
+	resources.clear();
+	passes.clear();
+	accesses.clear();
+	order.clear();
+	physicalTextures.clear();
+}
+
+RenderResource RenderGraph::CreateTexture(const char* name, const TextureDesc& desc) {
+	resources.push_back({ name, desc, false, InvalidPhysical, 0, 0 });
+	return static_cast<RenderResource>(resources.size() - 1);
+}
+
+RenderResource RenderGraph::ImportTexture(const char* name, const TextureDesc& desc) {
+	resources.push_back({ name, desc, true, InvalidPhysical, 0, 0 });
+	return static_cast<RenderResource>(resources.size() - 1);
+}
+
+RenderPassBuilder RenderGraph::AddPass(const char* name, ExecuteFunction execute) {
+	passes.push_back({ name, std::move(execute), false, false });
+	return RenderPassBuilder(*this, static_cast<uint32_t>(passes.size() - 1));
+}
+
+void RenderGraph::AddAccess(uint32_t pass, RenderResource resource, bool write) {
+	accesses.push_back({ pass, resource, write });
+}
+
+/* compilation */
+
+bool RenderGraph::Compile() {
+	order.clear();
+	physicalTextures.clear();
+	for (Pass& pass : passes) {
+		pass.culled = false;
+	}
+	if (!BuildEdges()) {
+		return false;
+	}
+	CullPasses();
+	SortPasses();
+	AssignPhysicalTextures();
+	return true;
+}
+
+// a pass depends on the last pass declared before it that wrote what it reads or writes,
+// and a write also waits for every read of the previous contents
+bool RenderGraph::BuildEdges() {
+	// builders may be used in any order, the passes' declaration order is what counts
+	std::stable_sort(accesses.begin(), accesses.end(), [](const Access& a, const Access& b) { return a.pass < b.pass; });
+
+	edges.clear();
+	lastWriter.assign(resources.size(), NoPass);
+	readersSinceWrite.resize(resources.size());
+	for (std::vector<uint32_t>& readers : readersSinceWrite) {
+		readers.clear();
+	}
+
+	for (const Access& access : accesses) {
+		const uint32_t writer = lastWriter[access.resource];
+		if (!access.write) {
+			if (writer == NoPass && !resources[access.resource].imported) {
+				Log.error(std::string("[RenderGraph] pass ") + passes[access.pass].name + " reads "
+					+ resources[access.resource].name + " before any pass writes it");
+				return false;
+			}
+			if (writer != NoPass && writer != access.pass) {
+				edges.push_back({ writer, access.pass, true });
+			}
+			readersSinceWrite[access.resource].push_back(access.pass);
+			continue;
+		}
+
+		if (writer != NoPass && writer != access.pass) {
+			edges.push_back({ writer, access.pass, true });
+		}
+		for (uint32_t reader : readersSinceWrite[access.resource]) {
+			if (reader != access.pass) {
+				edges.push_back({ reader, access.pass, false });
+			}
+		}
+		readersSinceWrite[access.resource].clear();
+		lastWriter[access.resource] = access.pass;
+	}
+	return true;
+}
+
+// keeps passes with side effects or writes to imported textures and everything whose results they use
+void RenderGraph::CullPasses() {
+	for (Pass& pass : passes) {
+		pass.culled = !pass.sideEffect;
+	}
+	for (const Access& access : accesses) {
+		if (access.write && resources[access.resource].imported) {
+			passes[access.pass].culled = false;
+		}
+	}
+
+	// walk the data dependencies backwards until nothing changes, graphs have a handful of passes
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (const Edge& edge : edges) {
+			if (edge.data && !passes[edge.to].culled && passes[edge.from].culled) {
+				passes[edge.from].culled = false;
+				changed = true;
+			}
+		}
+	}
+}
+
+// topological order of the kept passes; of the passes that are ready, the one whose inputs were
+// produced last goes first, so consumers run right after their producers and transient lifetimes
+// stay short enough to alias; ties keep the declaration order
+void RenderGraph::SortPasses() {
+	const uint32_t passCount = static_cast<uint32_t>(passes.size());
+	inDegree.assign(passCount, 0);
+	readyAfter.assign(passCount, 0); // 1 + position of the latest dependency, 0 for none
+	position.assign(passCount, NoPass);
+	for (const Edge& edge : edges) {
+		if (!passes[edge.from].culled && !passes[edge.to].culled) {
+			++inDegree[edge.to];
+		}
+	}
+
+	uint32_t keptCount = 0;
+	for (const Pass& pass : passes) {
+		keptCount += pass.culled ? 0 : 1;
+	}
+	while (order.size() < keptCount) {
+		uint32_t next = NoPass;
+		for (uint32_t pass = 0; pass < passCount; ++pass) {
+			if (passes[pass].culled || position[pass] != NoPass || inDegree[pass] != 0) {
+				continue;
+			}
+			if (next == NoPass || readyAfter[pass] > readyAfter[next]) {
+				next = pass;
+			}
+		}
+		// edges only point from earlier to later declarations, so some pass is always ready
+
+		position[next] = static_cast<uint32_t>(order.size());
+		order.push_back(next);
+		for (const Edge& edge : edges) {
+			if (edge.from == next && !passes[edge.to].culled) {
+				--inDegree[edge.to];
+				readyAfter[edge.to] = position[next] + 1;
+			}
+		}
+	}
+}
+
+// interval packing: transient textures sorted by first use take the first physical texture
+// with the same description whose last user ran before them
+void RenderGraph::AssignPhysicalTextures() {
+	for (Resource& resource : resources) {
+		resource.physical = InvalidPhysical;
+		resource.firstUse = NoPass;
+		resource.lastUse = 0;
+	}
+	for (const Access& access : accesses) {
+		if (passes[access.pass].culled) {
+			continue;
+		}
+		Resource& resource = resources[access.resource];
+		resource.firstUse = std::min(resource.firstUse, position[access.pass]);
+		resource.lastUse = std::max(resource.lastUse, position[access.pass]);
+	}
+
+	byFirstUse.clear();
+	for (RenderResource resource = 0; resource < resources.size(); ++resource) {
+		if (!resources[resource].imported && resources[resource].firstUse != NoPass) {
+			byFirstUse.push_back(resource);
+		}
+	}
+	std::sort(byFirstUse.begin(), byFirstUse.end(), [this](RenderResource a, RenderResource b) {
+		return resources[a].firstUse < resources[b].firstUse;
+	});
+
+	physicalLastUse.clear();
+	for (RenderResource index : byFirstUse) {
+		Resource& resource = resources[index];
+		for (uint32_t physical = 0; physical < physicalTextures.size(); ++physical) {
+			if (physicalTextures[physical] == resource.desc && physicalLastUse[physical] < resource.firstUse) {
+				resource.physical = physical;
+				break;
+			}
+		}
+		if (resource.physical == InvalidPhysical) {
+			resource.physical = static_cast<uint32_t>(physicalTextures.size());
+			physicalTextures.push_back(resource.desc);
+			physicalLastUse.push_back(0);
+		}
+		physicalLastUse[resource.physical] = resource.lastUse;
+	}
+}
+
+size_t RenderGraph::TransientCount() const {
+	size_t count = 0;
+	for (const Resource& resource : resources) {
+		count += resource.physical != InvalidPhysical ? 1 : 0;
+	}
+	return count;
+}
+
+/* execution */
+
+void RenderGraph::Execute() const {
+	for (uint32_t pass : order) {
+		PROFILE_ZONE(passes[pass].name);
+		passes[pass].execute(*this);
+	}
+}
\ No newline at end of file
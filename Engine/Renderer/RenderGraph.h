@@ -0,0 +1,147 @@
+//
+// Render Graph
+// Passes declare the textures they read and write instead of binding them directly;
+// Compile orders the passes by those dependencies (running consumers right after their
+// producers), culls the ones nothing depends on and works out the first and last use of
+// every transient texture, so textures whose lifetimes do not overlap share one physical texture
+// Knows nothing about the graphics API: backends create the physical textures Compile
+// asks for, imported textures (e.g. the back buffer) stay owned by the backend
+//
+// The graph is built once and only rebuilt when its inputs change (e.g. on resize),
+// Execute then runs the compiled order every frame without allocating
+//
+
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+enum class TextureFormat : uint8_t {
+	RGBA8,
+	RGBA16F,
+	Depth24Stencil8,
+};
+
+struct TextureDesc {
+	uint32_t width{};
+	uint32_t height{};
+	TextureFormat format{ TextureFormat::RGBA8 };
+
+	constexpr bool operator==(const TextureDesc& other) const {
+		return width == other.width && height == other.height && format == other.format;
+	}
+	constexpr bool operator!=(const TextureDesc& other) const { return !(*this == other); }
+};
+
+// index of a texture declared in the graph
+using RenderResource = uint32_t;
+inline constexpr RenderResource InvalidResource = UINT32_MAX;
+
+class RenderGraph;
+
+// returned by AddPass to declare what the pass touches, a read sees the writes of the passes added before it
+class RenderPassBuilder {
+public:
+	RenderPassBuilder& Read(RenderResource resource);
+	// render target, depth buffer or any other write, the pass sees what earlier writers left
+	RenderPassBuilder& Write(RenderResource resource);
+	// keeps the pass even when nothing depends on its writes, e.g. readbacks
+	RenderPassBuilder& SideEffect();
+private:
+	friend class RenderGraph;
+	RenderPassBuilder(RenderGraph& graph, uint32_t pass) : graph{ graph }, pass{ pass } {}
+
+	RenderGraph& graph;
+	uint32_t pass;
+};
+
+class RenderGraph {
+public:
+	static constexpr uint32_t InvalidPhysical = UINT32_MAX;
+
+	using ExecuteFunction = std::function<void(const RenderGraph&)>;
+
+	// forgets every pass and resource, the capacity is kept for the next build
+	void Reset();
+
+	/* declaration, names must outlive the graph */
+	// created and owned by the graph, contents are undefined before the first write
+	RenderResource CreateTexture(const char* name, const TextureDesc& desc);
+	// owned by the backend, always treated as an output so passes writing it are kept
+	RenderResource ImportTexture(const char* name, const TextureDesc& desc);
+	RenderPassBuilder AddPass(const char* name, ExecuteFunction execute);
+
+	// orders and culls the passes and assigns physical textures, false if a pass reads a
+	// transient texture nothing wrote before it
+	bool Compile();
+	// runs the compiled passes in order
+	void Execute() const;
+
+	/* compiled results */
+	const TextureDesc& Desc(RenderResource resource) const { return resources[resource].desc; }
+	bool IsImported(RenderResource resource) const { return resources[resource].imported; }
+	// physical texture backing a transient resource, InvalidPhysical for imported or unused ones
+	uint32_t Physical(RenderResource resource) const { return resources[resource].physical; }
+	// one entry per texture the backend has to create, indexed by Physical()
+	const std::vector<TextureDesc>& PhysicalTextures() const { return physicalTextures; }
+
+	size_t PassCount() const { return passes.size(); }
+	size_t ExecutedPassCount() const { return order.size(); }
+	size_t TransientCount() const;
+	const char* PassName(uint32_t pass) const { return passes[pass].name; }
+	// indices of the passes in execution order
+	const std::vector<uint32_t>& ExecutionOrder() const { return order; }
+private:
+	friend class RenderPassBuilder;
+
+	struct Resource {
+		const char* name;
+		TextureDesc desc;
+		bool imported;
+		uint32_t physical;
+		uint32_t firstUse; // positions in the execution order
+		uint32_t lastUse;
+	};
+
+	struct Access {
+		uint32_t pass;
+		RenderResource resource;
+		bool write;
+	};
+
+	struct Pass {
+		const char* name;
+		ExecuteFunction execute;
+		bool sideEffect;
+		bool culled;
+	};
+
+	// pass to depends on pass from
+	struct Edge {
+		uint32_t from;
+		uint32_t to;
+		bool data; // read after write or write after write, culling follows only these
+	};
+
+	std::vector<Resource> resources{};
+	std::vector<Pass> passes{};
+	std::vector<Access> accesses{}; // in declaration order
+	std::vector<uint32_t> order{};
+	std::vector<TextureDesc> physicalTextures{};
+
+	/* compile scratch */
+	std::vector<Edge> edges{};
+	std::vector<uint32_t> lastWriter{};
+	std::vector<std::vector<uint32_t>> readersSinceWrite{};
+	std::vector<uint32_t> inDegree{};
+	std::vector<uint32_t> readyAfter{};
+	std::vector<uint32_t> position{};
+	std::vector<RenderResource> byFirstUse{};
+	std::vector<uint32_t> physicalLastUse{};
+
+	void AddAccess(uint32_t pass, RenderResource resource, bool write);
+	bool BuildEdges();
+	void CullPasses();
+	void SortPasses();
+	void AssignPhysicalTextures();
+};
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "RenderThread.h"
+#include "Engine/Jobs/JobSystem.h"
+#include "Engine/Profiler/Profiler.h"
+#include "Util/Log.h"
+
+/* command list */
+
+void RenderCommandList::Reset() {
+	clear = false;
+	draws.clear();
+}
+
+void RenderCommandList::Execute(IRenderer& renderer) const {
+	renderer.BeginFrame(camera);
+	if (clear) {
+		renderer.ClearBackground(clearColor);
+	}
+	for (const DrawCommand& draw : draws) {
+		renderer.DrawMesh(draw.mesh, draw.world, draw.lod);
+	}
+	{
+		PROFILE_ZONE("Renderer EndFrame");
+		renderer.EndFrame();
+	}
+}
+
+/* render thread */
+
+RenderThread::~RenderThread() {
+	Stop();
+}
+
+void RenderThread::Start(IRenderer* pRenderer, bool threaded) {
+	if (Running()) {
+		return;
+	}
+	this->pRenderer = pRenderer;
+	shared.store(2, std::memory_order_relaxed);
+	writeIndex = 0;
+	readIndex = 1;
+	submitted = 0;
+	completed.store(0, std::memory_order_relaxed);
+	lists[writeIndex].Reset();
+
+	if (threaded) {
+		thread = std::thread(&RenderThread::Loop, this);
+	}
+}
+
+void RenderThread::Stop() {
+	if (!Running()) {
+		return;
+	}
+	shared.fetch_or(QuitBit, std::memory_order_release);
+	shared.notify_all();
+	thread.join();
+	thread = {};
+	// nothing will draw the dropped frames, let WaitIdle see them as done
+	completed.store(submitted, std::memory_order_release);
+}
+
+void RenderThread::Submit() {
+	if (!Running()) {
+		// nothing to hand over to, draw right here
+		PROFILE_ZONE("Render Frame");
+		lists[writeIndex].Execute(*pRenderer);
+		lists[writeIndex].Reset();
+		return;
+	}
+	PROFILE_ZONE("Submit Frame");
+
+	// the render thread has not taken the last frame yet, it is more than a frame behind
+	uint32_t current = shared.load(std::memory_order_acquire);
+	while (current & FreshBit) {
+		shared.wait(current, std::memory_order_acquire);
+		current = shared.load(std::memory_order_acquire);
+	}
+
+	++submitted;
+	// publish the recorded list and take over whichever one was shared
+	writeIndex = shared.exchange(writeIndex | FreshBit, std::memory_order_acq_rel) & IndexMask;
+	shared.notify_all();
+	lists[writeIndex].Reset();
+}
+
+void RenderThread::WaitIdle() {
+	if (!Running()) {
+		return;
+	}
+	uint64_t done = completed.load(std::memory_order_acquire);
+	while (done != submitted) {
+		completed.wait(done, std::memory_order_acquire);
+		done = completed.load(std::memory_order_acquire);
+	}
+}
+
+/* private functions */
+
+void RenderThread::Loop() {
+	Profiler::SetThreadName("Render");
+	// the software renderer shades tiles with jobs
+	if (!JobSystem::Get().AttachThread()) {
+		Log.warning("[Render] no job queue left for the render thread, tiles are shaded on it alone");
+	}
+
+	for (;;) {
+		uint32_t current = shared.load(std::memory_order_acquire);
+		while (!(current & (FreshBit | QuitBit))) {
+			shared.wait(current, std::memory_order_acquire);
+			current = shared.load(std::memory_order_acquire);
+		}
+		if (current & QuitBit) {
+			return;
+		}
+
+		// take the fresh list and leave the one just drawn in its place, a Stop that came in meanwhile must survive
+		while (!shared.compare_exchange_weak(current, readIndex | (current & QuitBit), std::memory_order_acq_rel, std::memory_order_acquire)) {
+		}
+		readIndex = current & IndexMask;
+		shared.notify_all();
+
+		{
+			PROFILE_ZONE("Render Frame");
+			lists[readIndex].Execute(*pRenderer);
+		}
+
+		completed.fetch_add(1, std::memory_order_release);
+		completed.notify_all();
+	}
+}
\ No newline at end of file
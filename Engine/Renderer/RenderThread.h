@@ -0,0 +1,77 @@
+//
+// Render Thread
+// The main thread records a frame into a RenderCommandList while the render
+// thread replays the previous one on the renderer. Lists are handed over
+// through a lock-free triple buffer, at most one finished frame waits in it
+// so the main thread never runs more than a frame ahead
+//
+// While a render thread runs, the renderer may only be touched directly
+// (meshes, resize, options) after WaitIdle and before the next Submit
+//
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "IRenderer.h"
+
+struct DrawCommand {
+	Mat4 world;
+	MeshHandle mesh;
+	uint32_t lod;
+};
+
+// everything the renderer needs for one frame, copied so the scene can change while it is drawn
+class RenderCommandList {
+public:
+	void Reset();
+
+	void SetCamera(const Camera& camera) { this->camera = camera; }
+	void ClearBackground(ColorRGB color) { clear = true; clearColor = color; }
+	void DrawMesh(MeshHandle mesh, const Mat4& world, uint32_t lod) { draws.push_back({ world, mesh, lod }); }
+
+	void Execute(IRenderer& renderer) const;
+private:
+	Camera camera{};
+	bool clear{ false };
+	ColorRGB clearColor{};
+	std::vector<DrawCommand> draws{};
+};
+
+class RenderThread {
+public:
+	RenderThread() = default;
+	~RenderThread();
+
+	// threaded false draws every frame inside Submit instead, e.g. to compare against the pipelined loop
+	void Start(IRenderer* pRenderer, bool threaded = true);
+	// finishes the frame in flight, frames not started yet are dropped
+	void Stop();
+	bool Running() const { return thread.joinable(); }
+
+	// the list to record the next frame into, valid until Submit
+	RenderCommandList& Recording() { return lists[writeIndex]; }
+	// hands the recorded frame to the render thread, waits while the previous one was not picked up yet
+	void Submit();
+	// returns once every submitted frame has been drawn
+	void WaitIdle();
+private:
+	// low bits of shared hold the index of the list not owned by either thread
+	static constexpr uint32_t IndexMask = 0x3;
+	static constexpr uint32_t FreshBit = 0x4; // the shared list holds a frame not drawn yet
+	static constexpr uint32_t QuitBit = 0x8;
+
+	IRenderer* pRenderer{ nullptr };
+	std::thread thread{};
+
+	RenderCommandList lists[3]{};
+	uint32_t writeIndex{ 0 };            // main thread only
+	uint32_t readIndex{ 1 };             // render thread only
+	std::atomic<uint32_t> shared{ 2 };
+
+	uint64_t submitted{ 0 };             // main thread only
+	std::atomic<uint64_t> completed{ 0 };
+
+	void Loop();
+};
\ No newline at end of file
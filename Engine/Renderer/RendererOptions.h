@@ -1,5 +1,31 @@
 #pragma once
+#include <cstdint>
+
+enum class RendererBackend {
+	Direct3D11,
+	Software, // CPU rasterizer, for machines without a GPU
+	Null,     // does all per-frame CPU work but never touches a GPU
+};
 
 struct RendererOptions {
 	bool vSync;
+	// frame rate cap while vSync is off, 0 runs uncapped
+	float fpsLimit{ 0.0f };
+	// draw on a separate thread, one frame behind the simulation
+	bool renderThread{ true };
+	RendererBackend backend{ RendererBackend::Direct3D11 };
+	int width{ 1280 };
+	int height{ 720 };
+
+	/* headless: no window, no presentation, Engine::Run drives a fixed number of frames */
+	bool headless{ false };
+	uint32_t headlessFrames{ 1000 };
+	float headlessDeltaTime{ 1.0f / 60.0f };
+
+	// extra cubes added to the scene, for profiling large scenes
+	uint32_t stressObjects{ 0 };
+	// frames captured by the profiler from the start, written to trace.json
+	uint32_t traceFrames{ 0 };
+	// watch assets/ and reload changed shaders and meshes between frames
+	bool hotReload{ true };
 };
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "ShaderCache.h"
+#include "Util/Log.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#ifdef _WIN32
+#include <d3dcompiler.h>
+#pragma comment(lib, "d3dcompiler.lib")
+#include <wrl.h>
+#endif
+
+namespace {
+	// bump when the key or file layout changes so old entries are never picked up
+	constexpr uint32_t CacheVersion = 1;
+
+	// FNV-1a, 64 bit
+	constexpr uint64_t FnvOffset = 14695981039346656037ull;
+	constexpr uint64_t FnvPrime = 1099511628211ull;
+
+	void HashBytes(uint64_t& hash, const void* data, size_t size) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; ++i) {
+			hash = (hash ^ bytes[i]) * FnvPrime;
+		}
+	}
+
+	// strings are hashed with their terminator so ("ab", "c") and ("a", "bc") differ
+	void HashString(uint64_t& hash, const std::string& s) {
+		HashBytes(hash, s.c_str(), s.size() + 1);
+	}
+
+	bool ReadFile(const std::string& path, std::string& out) {
+		std::ifstream file{ path, std::ios::binary };
+		if (!file) {
+			return false;
+		}
+		out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		return true;
+	}
+}
+
+ShaderCache::ShaderCache(std::string directory)
+	: directory{ std::move(directory) } {}
+
+bool ShaderCache::Load(const ShaderDesc& desc, std::vector<uint8_t>& bytecode) {
+	std::string source{};
+	if (!ReadFile(desc.path, source)) {
+		Log.error(std::string("[Shader] could not read ") + desc.path);
+		return false;
+	}
+
+	char keyText[17]{};
+	std::snprintf(keyText, sizeof(keyText), "%016llx", static_cast<unsigned long long>(Key(desc, source)));
+	const std::filesystem::path cachePath = std::filesystem::path(directory) / (std::string(desc.name) + "_" + keyText + ".cso");
+
+	std::string cached{};
+	if (ReadFile(cachePath.string(), cached) && !cached.empty()) {
+		bytecode.assign(cached.begin(), cached.end());
+		++hits;
+		return true;
+	}
+
+	++misses;
+	Log.info(std::string("[Shader] compiling ") + desc.path);
+	if (!Compile(desc, source, bytecode)) {
+		return false;
+	}
+
+	// write next to the final name and rename, a crash mid-write must not leave a truncated entry behind
+	std::error_code ec{};
+	std::filesystem::create_directories(directory, ec);
+	const std::filesystem::path tempPath = cachePath.string() + ".tmp";
+	{
+		std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+		file.write(reinterpret_cast<const char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size()));
+		if (!file) {
+			Log.warning("[Shader] could not write " + tempPath.string());
+			return true; // the bytecode itself is fine, the next start just compiles again
+		}
+	}
+	std::filesystem::rename(tempPath, cachePath, ec);
+	if (ec) {
+		Log.warning("[Shader] could not store " + cachePath.string());
+		std::filesystem::remove(tempPath, ec);
+	}
+	return true;
+}
+
+bool ShaderCache::Build(const ShaderDesc* const* shaders, size_t count) {
+	bool ok = true;
+	std::vector<uint8_t> bytecode{};
+	for (size_t i = 0; i < count; ++i) {
+		ok &= Load(*shaders[i], bytecode);
+	}
+	Log.info("[Shader] " + std::to_string(hits) + " cached, " + std::to_string(misses) + " compiled");
+	return ok;
+}
+
+/* private functions */
+
+uint32_t ShaderCache::CompileFlags() {
+#if defined(_WIN32) && defined(_DEBUG)
+	return D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#elif defined(_WIN32)
+	return D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#else
+	return 0;
+#endif
+}
+
+uint64_t ShaderCache::Key(const ShaderDesc& desc, const std::string& source) {
+	uint64_t hash = FnvOffset;
+	HashBytes(hash, &CacheVersion, sizeof(CacheVersion));
+#ifdef _WIN32
+	const uint32_t compilerVersion = D3D_COMPILER_VERSION;
+	HashBytes(hash, &compilerVersion, sizeof(compilerVersion));
+#endif
+	const uint32_t flags = CompileFlags();
+	HashBytes(hash, &flags, sizeof(flags));
+	HashString(hash, desc.entryPoint);
+	HashString(hash, desc.target);
+	for (const ShaderDefine& define : desc.defines) {
+		HashString(hash, define.name);
+		HashString(hash, define.value);
+	}
+	HashString(hash, source);
+	return hash;
+}
+
+bool ShaderCache::Compile(const ShaderDesc& desc, const std::string& source, std::vector<uint8_t>& bytecode) {
+#ifdef _WIN32
+	std::vector<D3D_SHADER_MACRO> macros{};
+	for (const ShaderDefine& define : desc.defines) {
+		macros.push_back({ define.name.c_str(), define.value.c_str() });
+	}
+	macros.push_back({ nullptr, nullptr });
+
+	Microsoft::WRL::ComPtr<ID3DBlob> blob{ nullptr };
+	Microsoft::WRL::ComPtr<ID3DBlob> errors{ nullptr };
+	HRESULT hr = D3DCompile(source.data(), source.size(), desc.path, macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE,
+		desc.entryPoint, desc.target, CompileFlags(), 0, blob.ReleaseAndGetAddressOf(), errors.ReleaseAndGetAddressOf());
+	if (FAILED(hr)) {
+		std::string message = std::string("[Shader] failed to compile ") + desc.path;
+		if (errors) {
+			message += ":\n" + std::string(static_cast<const char*>(errors->GetBufferPointer()), errors->GetBufferSize());
+		}
+		Log.error(message);
+		return false;
+	}
+
+	const uint8_t* data = static_cast<const uint8_t*>(blob->GetBufferPointer());
+	bytecode.assign(data, data + blob->GetBufferSize());
+	return true;
+#else
+	Log.error(std::string("[Shader] no shader compiler on this platform for ") + desc.path);
+	return false;
+#endif
+}
\ No newline at end of file
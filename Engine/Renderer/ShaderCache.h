@@ -0,0 +1,53 @@
+//
+// Shader Cache
+// Compiled shader bytecode on disk, keyed by a hash of everything that
+// affects the output: source, defines, entry point, target, flags and compiler
+// A warm start only reads files, -compile-shaders fills the cache offline
+//
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ShaderDefine {
+	std::string name;
+	std::string value;
+};
+
+struct ShaderDesc {
+	const char* name;       // prefix of the cache file
+	const char* path;
+	const char* entryPoint;
+	const char* target;     // e.g. vs_5_0
+	std::vector<ShaderDefine> defines{};
+};
+
+// every shader the engine uses, compiled up front by -compile-shaders
+namespace EngineShaders {
+	inline const ShaderDesc Vertex{ "VertexShader", "assets/shaders/VertexShader.hlsl", "vs_main", "vs_5_0" };
+	inline const ShaderDesc Pixel{ "PixelShader", "assets/shaders/PixelShader.hlsl", "ps_main", "ps_5_0" };
+	inline const ShaderDesc* const All[] = { &Vertex, &Pixel };
+}
+
+class ShaderCache {
+public:
+	explicit ShaderCache(std::string directory = "shadercache");
+
+	// cached bytecode if nothing in the key changed, otherwise compiles and stores it
+	bool Load(const ShaderDesc& desc, std::vector<uint8_t>& bytecode);
+	// loads every shader, returns false if any of them failed to compile
+	bool Build(const ShaderDesc* const* shaders, size_t count);
+
+	uint32_t Hits() const { return hits; }
+	uint32_t Misses() const { return misses; }
+private:
+	std::string directory{};
+	uint32_t hits{};
+	uint32_t misses{};
+
+	static uint32_t CompileFlags();
+	// #include'd files are not part of the key, none of the engine's shaders use them
+	static uint64_t Key(const ShaderDesc& desc, const std::string& source);
+	static bool Compile(const ShaderDesc& desc, const std::string& source, std::vector<uint8_t>& bytecode);
+};
\ No newline at end of file
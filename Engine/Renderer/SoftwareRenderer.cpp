@@ -0,0 +1,462 @@
+#include "SoftwareRenderer.h"
+#include "Util/Log.h"
+#include "Engine/Jobs/JobSystem.h"
+#include "Engine/Profiler/Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+#include "Util/Math/Mat4.h"
+
+#ifdef _WIN32
+#include <dwmapi.h>
+#pragma comment(lib, "dwmapi.lib")
+#endif
+
+namespace {
+	uint32_t PackColor(ColorRGB color) {
+		auto channel = [](float c) { return static_cast<uint32_t>(std::clamp(c, 0.0f, 255.0f)); };
+		return (channel(color.a) << 24) | (channel(color.r) << 16) | (channel(color.g) << 8) | channel(color.b);
+	}
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+	Shutdown();
+}
+
+bool SoftwareRenderer::Initialize(NativeWindow hWnd, RendererOptions* pRendererOptions) {
+	Log.info("Initializing software renderer...");
+	this->hWnd = hWnd;
+	this->pOpts = pRendererOptions;
+
+	int width = pRendererOptions->width;
+	int height = pRendererOptions->height;
+#ifdef _WIN32
+	if (hWnd) {
+		RECT clientRect{};
+		GetClientRect(hWnd, &clientRect);
+		width = clientRect.right - clientRect.left;
+		height = clientRect.bottom - clientRect.top;
+	}
+#endif
+	ResizeBuffers(width, height);
+
+	Log.info("Software renderer using " + std::to_string(JobSystem::Get().ThreadCount()) + " threads, "
+		+ std::to_string(tilesX * tilesY) + " tiles of " + std::to_string(TileSize) + "x" + std::to_string(TileSize));
+
+	return true;
+}
+
+bool SoftwareRenderer::CompileShaders() {
+	// shading is fixed function, nothing to compile
+	return true;
+}
+
+void SoftwareRenderer::Shutdown() {
+}
+
+void SoftwareRenderer::OnResize(int width, int height) {
+	ResizeBuffers(width, height);
+}
+
+float SoftwareRenderer::AspectRatio() const {
+	return static_cast<float>(clientWidth) / static_cast<float>(clientHeight);
+}
+
+MeshHandle SoftwareRenderer::CreateMesh(const MeshData& data) {
+	meshes.emplace_back();
+	UpdateMesh(static_cast<MeshHandle>(meshes.size() - 1), data);
+	return static_cast<MeshHandle>(meshes.size() - 1);
+}
+
+bool SoftwareRenderer::UpdateMesh(MeshHandle mesh, const MeshData& data) {
+	if (mesh >= meshes.size()) {
+		return false;
+	}
+	// decoded to floats once here, the rasterizer only deals with one format
+	Mesh& m = meshes[mesh];
+	m.positions.resize(data.vertexCount);
+	m.colors.resize(data.vertexCount);
+	for (uint32_t i = 0; i < data.vertexCount; ++i) {
+		m.positions[i] = data.Position(i);
+		m.colors[i] = data.Color(i);
+	}
+	m.indices.resize(data.indexCount);
+	for (uint32_t i = 0; i < data.indexCount; ++i) {
+		m.indices[i] = data.Index(i);
+	}
+	m.lods.resize(data.LodCount());
+	for (uint32_t level = 0; level < data.LodCount(); ++level) {
+		m.lods[level] = data.Lod(level);
+	}
+	return true;
+}
+
+void SoftwareRenderer::DestroyMesh(MeshHandle mesh) {
+	if (mesh >= meshes.size()) {
+		return;
+	}
+	// a fresh Mesh gives the memory back, clear() would keep the capacity
+	meshes[mesh] = Mesh{};
+}
+
+/* drawing */
+
+void SoftwareRenderer::BeginFrame(const Camera& camera) {
+	viewProj = camera.ViewProj();
+	triangles.clear();
+	for (FrameVector<uint32_t>& bin : tileBins) {
+		bin = FrameVector<uint32_t>(ArenaAllocator<uint32_t>(binArena));
+	}
+	binArena.Reset();
+}
+
+void SoftwareRenderer::EndFrame() {
+	RasterizeTiles();
+	Present();
+	stats.EndFrame();
+}
+
+void SoftwareRenderer::ClearBackground(ColorRGB color) {
+	// tiles clear themselves right before they are shaded
+	clearColor = PackColor(color);
+}
+
+void SoftwareRenderer::DrawRect(Rect rect, ColorRGB color) {
+
+}
+void SoftwareRenderer::DrawFilledRect(Rect rect, ColorRGB color, float thickness) {
+
+}
+void SoftwareRenderer::DrawLine(Vec2 pos, ColorRGB color, float thickness) {
+
+}
+
+void SoftwareRenderer::DrawMesh(MeshHandle mesh, const Mat4& world, uint32_t lod) {
+	if (mesh >= meshes.size() || meshes[mesh].lods.empty()) {
+		return;
+	}
+	const Mesh& m = meshes[mesh];
+	const MeshLod& range = m.lods[std::min<size_t>(lod, m.lods.size() - 1)];
+
+	Mat4 worldViewProj = world * viewProj;
+
+	const size_t vertexCount = m.positions.size();
+	transformed.resize(vertexCount);
+	clipVertices.resize(vertexCount);
+	TransformPoints(m.positions.data(), vertexCount, worldViewProj, transformed.data());
+
+	for (size_t i = 0; i < vertexCount; ++i) {
+		const Vec4& p = transformed[i];
+		const Vec4& c = m.colors[i];
+		clipVertices[i] = { p.x, p.y, p.z, p.w, c.x, c.y, c.z, c.w };
+	}
+
+	stats.CountDraw(range.indexCount / 3);
+	const uint32_t* indices = m.indices.data() + range.firstIndex;
+	for (uint32_t i = 0; i + 2 < range.indexCount; i += 3) {
+		ClipAndSetup(clipVertices[indices[i]], clipVertices[indices[i + 1]], clipVertices[indices[i + 2]]);
+	}
+}
+
+/* private functions */
+
+void SoftwareRenderer::ResizeBuffers(int width, int height) {
+	clientWidth = std::max(width, 1);
+	clientHeight = std::max(height, 1);
+	tilesX = (clientWidth + TileSize - 1) / TileSize;
+	tilesY = (clientHeight + TileSize - 1) / TileSize;
+
+	// rows are padded out to whole tiles so 4 wide pixel groups never run off a row
+	colorBuffer.assign(static_cast<size_t>(tilesX) * TileSize * clientHeight, clearColor);
+	depthBuffer.assign(static_cast<size_t>(tilesX) * TileSize * clientHeight, 1.0f);
+	tileBins.assign(static_cast<size_t>(tilesX) * tilesY, FrameVector<uint32_t>(ArenaAllocator<uint32_t>(binArena)));
+}
+
+void SoftwareRenderer::ClipAndSetup(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2) {
+	// trivially reject triangles entirely outside one of the side planes
+	if ((v0.x > v0.w && v1.x > v1.w && v2.x > v2.w) || (v0.x < -v0.w && v1.x < -v1.w && v2.x < -v2.w) ||
+		(v0.y > v0.w && v1.y > v1.w && v2.y > v2.w) || (v0.y < -v0.w && v1.y < -v1.w && v2.y < -v2.w)) {
+		return;
+	}
+
+	// only the near plane (z >= 0) needs real clipping, it also keeps w positive
+	const ClipVertex* in[3] = { &v0, &v1, &v2 };
+	int insideCount = (v0.z >= 0.0f) + (v1.z >= 0.0f) + (v2.z >= 0.0f);
+	if (insideCount == 3) {
+		SetupTriangle(v0, v1, v2);
+		return;
+	}
+	if (insideCount == 0) {
+		return;
+	}
+
+	ClipVertex out[4]{};
+	int outCount = 0;
+	for (int i = 0; i < 3; ++i) {
+		const ClipVertex& a = *in[i];
+		const ClipVertex& b = *in[(i + 1) % 3];
+		if (a.z >= 0.0f) {
+			out[outCount++] = a;
+		}
+		if ((a.z >= 0.0f) != (b.z >= 0.0f)) {
+			float t = a.z / (a.z - b.z);
+			const float* pa = &a.x;
+			const float* pb = &b.x;
+			float* po = &out[outCount++].x;
+			for (int c = 0; c < 8; ++c) {
+				po[c] = pa[c] + (pb[c] - pa[c]) * t;
+			}
+		}
+	}
+
+	for (int i = 1; i + 1 < outCount; ++i) {
+		SetupTriangle(out[0], out[i], out[i + 1]);
+	}
+}
+
+void SoftwareRenderer::SetupTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2) {
+	const ClipVertex* v[3] = { &v0, &v1, &v2 };
+	const float halfWidth = clientWidth * 0.5f;
+	const float halfHeight = clientHeight * 0.5f;
+
+	// perspective divide and viewport transform
+	float sx[3], sy[3], sz[3], invW[3];
+	for (int i = 0; i < 3; ++i) {
+		invW[i] = 1.0f / v[i]->w;
+		sx[i] = (v[i]->x * invW[i] + 1.0f) * halfWidth;
+		sy[i] = (1.0f - v[i]->y * invW[i]) * halfHeight;
+		sz[i] = v[i]->z * invW[i];
+	}
+
+	// clockwise is front facing (y points down in screen space), matches the D3D rasterizer state
+	float area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sy[1] - sy[0]) * (sx[2] - sx[0]);
+	if (!(area > 0.0f)) {
+		return;
+	}
+
+	// clamp in float first, vertices close to the near plane can land far outside the screen
+	const float maxScreenX = static_cast<float>(clientWidth - 1);
+	const float maxScreenY = static_cast<float>(clientHeight - 1);
+	float minSX = std::floor(std::min({ sx[0], sx[1], sx[2] }));
+	float minSY = std::floor(std::min({ sy[0], sy[1], sy[2] }));
+	float maxSX = std::ceil(std::max({ sx[0], sx[1], sx[2] }));
+	float maxSY = std::ceil(std::max({ sy[0], sy[1], sy[2] }));
+	if (minSX > maxScreenX || minSY > maxScreenY || maxSX < 0.0f || maxSY < 0.0f) {
+		return;
+	}
+
+	Triangle tri{};
+	tri.minX = static_cast<int32_t>(std::max(minSX, 0.0f));
+	tri.minY = static_cast<int32_t>(std::max(minSY, 0.0f));
+	tri.maxX = static_cast<int32_t>(std::min(maxSX, maxScreenX));
+	tri.maxY = static_cast<int32_t>(std::min(maxSY, maxScreenY));
+
+	// edge k is opposite vertex k, so edge[k] / area is the barycentric weight of vertex k
+	for (int k = 0; k < 3; ++k) {
+		int i = (k + 1) % 3;
+		int j = (k + 2) % 3;
+		float dx = sx[j] - sx[i];
+		float dy = sy[j] - sy[i];
+		tri.edge[k].a = -dy;
+		tri.edge[k].b = dx;
+		tri.edge[k].c = dy * sx[i] - dx * sy[i];
+
+		bool topLeft = dy < 0.0f || (dy == 0.0f && dx > 0.0f);
+		tri.topLeft[k] = topLeft ? 0xFFFFFFFFu : 0u;
+	}
+
+	const float invArea = 1.0f / area;
+	auto makePlane = [&](float a0, float a1, float a2) {
+		Plane p{};
+		p.a = (tri.edge[0].a * a0 + tri.edge[1].a * a1 + tri.edge[2].a * a2) * invArea;
+		p.b = (tri.edge[0].b * a0 + tri.edge[1].b * a1 + tri.edge[2].b * a2) * invArea;
+		p.c = (tri.edge[0].c * a0 + tri.edge[1].c * a1 + tri.edge[2].c * a2) * invArea;
+		return p;
+	};
+	tri.depth = makePlane(sz[0], sz[1], sz[2]);
+	tri.invW = makePlane(invW[0], invW[1], invW[2]);
+	tri.color[0] = makePlane(v0.r * invW[0], v1.r * invW[1], v2.r * invW[2]);
+	tri.color[1] = makePlane(v0.g * invW[0], v1.g * invW[1], v2.g * invW[2]);
+	tri.color[2] = makePlane(v0.b * invW[0], v1.b * invW[1], v2.b * invW[2]);
+	tri.color[3] = makePlane(v0.a * invW[0], v1.a * invW[1], v2.a * invW[2]);
+
+	uint32_t index = static_cast<uint32_t>(triangles.size());
+	triangles.push_back(tri);
+
+	// bin into every tile the bounding box touches, submission order is kept per tile
+	for (int ty = tri.minY / TileSize; ty <= tri.maxY / TileSize; ++ty) {
+		for (int tx = tri.minX / TileSize; tx <= tri.maxX / TileSize; ++tx) {
+			tileBins[ty * tilesX + tx].push_back(index);
+		}
+	}
+}
+
+void SoftwareRenderer::RasterizeTiles() {
+	PROFILE_ZONE("Rasterize Tiles");
+	// one tile per job, tiles own disjoint pixels so no synchronization is needed
+	const uint32_t tileCount = static_cast<uint32_t>(tilesX * tilesY);
+	JobSystem::Get().ParallelFor(tileCount, 1, [this](uint32_t begin, uint32_t end) {
+		for (uint32_t tile = begin; tile < end; ++tile) {
+			RasterizeTile(static_cast<int>(tile));
+		}
+	});
+}
+
+void SoftwareRenderer::RasterizeTile(int tileIndex) {
+	const int pitch = tilesX * TileSize;
+	const int x0 = (tileIndex % tilesX) * TileSize;
+	const int y0 = (tileIndex / tilesX) * TileSize;
+	const int x1 = x0 + TileSize;
+	const int y1 = std::min(y0 + TileSize, clientHeight);
+
+	for (int y = y0; y < y1; ++y) {
+		std::fill_n(&colorBuffer[static_cast<size_t>(y) * pitch + x0], TileSize, clearColor);
+		std::fill_n(&depthBuffer[static_cast<size_t>(y) * pitch + x0], TileSize, 1.0f);
+	}
+
+	for (uint32_t index : tileBins[tileIndex]) {
+		RasterizeTriangle(triangles[index], x0, y0, x1, y1);
+	}
+}
+
+void SoftwareRenderer::RasterizeTriangle(const Triangle& tri, int x0, int y0, int x1, int y1) {
+	const int pitch = tilesX * TileSize;
+
+	// tile starts are multiples of 4, so aligning down stays inside the tile
+	const int minX = std::max(tri.minX, x0) & ~3;
+	const int minY = std::max(tri.minY, y0);
+	const int maxX = std::min(tri.maxX, x1 - 1);
+	const int maxY = std::min(tri.maxY, y1 - 1);
+
+#ifdef BUG_MATH_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(255.0f);
+	const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 startX = _mm_add_ps(_mm_set1_ps(static_cast<float>(minX)), laneOffsets);
+
+	__m128 edgeStep[3];
+	__m128 topLeft[3];
+	for (int k = 0; k < 3; ++k) {
+		edgeStep[k] = _mm_set1_ps(tri.edge[k].a * 4.0f);
+		topLeft[k] = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(tri.topLeft[k])));
+	}
+
+	auto evaluate = [](const Plane& p, __m128 px, __m128 py) {
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.a), px), _mm_mul_ps(_mm_set1_ps(p.b), py)), _mm_set1_ps(p.c));
+	};
+	auto toChannel = [&](__m128 c) {
+		c = _mm_min_ps(_mm_max_ps(c, zero), one);
+		return _mm_cvtps_epi32(_mm_mul_ps(c, scale));
+	};
+
+	for (int y = minY; y <= maxY; ++y) {
+		const __m128 py = _mm_set1_ps(static_cast<float>(y) + 0.5f);
+		__m128 px = startX;
+		__m128 edge[3];
+		for (int k = 0; k < 3; ++k) {
+			edge[k] = evaluate(tri.edge[k], px, py);
+		}
+
+		uint32_t* colorRow = &colorBuffer[static_cast<size_t>(y) * pitch];
+		float* depthRow = &depthBuffer[static_cast<size_t>(y) * pitch];
+
+		for (int x = minX; x <= maxX; x += 4) {
+			// inside if every edge is positive, or zero on a top-left edge
+			__m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int k = 0; k < 3; ++k) {
+				__m128 onEdge = _mm_and_ps(_mm_cmpeq_ps(edge[k], zero), topLeft[k]);
+				mask = _mm_and_ps(mask, _mm_or_ps(_mm_cmpgt_ps(edge[k], zero), onEdge));
+			}
+
+			if (_mm_movemask_ps(mask) != 0) {
+				__m128 depth = evaluate(tri.depth, px, py);
+				__m128 oldDepth = _mm_loadu_ps(depthRow + x);
+				mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmplt_ps(depth, oldDepth), _mm_cmple_ps(depth, one)));
+
+				if (_mm_movemask_ps(mask) != 0) {
+					_mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(mask, depth), _mm_andnot_ps(mask, oldDepth)));
+
+					__m128 w = _mm_div_ps(one, evaluate(tri.invW, px, py));
+					__m128i r = toChannel(_mm_mul_ps(evaluate(tri.color[0], px, py), w));
+					__m128i g = toChannel(_mm_mul_ps(evaluate(tri.color[1], px, py), w));
+					__m128i b = toChannel(_mm_mul_ps(evaluate(tri.color[2], px, py), w));
+					__m128i a = toChannel(_mm_mul_ps(evaluate(tri.color[3], px, py), w));
+					__m128i packed = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(a, 24), _mm_slli_epi32(r, 16)),
+						_mm_or_si128(_mm_slli_epi32(g, 8), b));
+
+					__m128i pixelMask = _mm_castps_si128(mask);
+					__m128i* dst = reinterpret_cast<__m128i*>(colorRow + x);
+					__m128i old = _mm_loadu_si128(dst);
+					_mm_storeu_si128(dst, _mm_or_si128(_mm_and_si128(pixelMask, packed), _mm_andnot_si128(pixelMask, old)));
+				}
+			}
+
+			for (int k = 0; k < 3; ++k) {
+				edge[k] = _mm_add_ps(edge[k], edgeStep[k]);
+			}
+			px = _mm_add_ps(px, _mm_set1_ps(4.0f));
+		}
+	}
+#else
+	auto evaluate = [](const Plane& p, float px, float py) { return p.a * px + p.b * py + p.c; };
+	auto toChannel = [](float c) { return static_cast<uint32_t>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f); };
+
+	for (int y = minY; y <= maxY; ++y) {
+		const float py = static_cast<float>(y) + 0.5f;
+		uint32_t* colorRow = &colorBuffer[static_cast<size_t>(y) * pitch];
+		float* depthRow = &depthBuffer[static_cast<size_t>(y) * pitch];
+
+		for (int x = minX; x <= maxX; ++x) {
+			const float px = static_cast<float>(x) + 0.5f;
+			bool inside = true;
+			for (int k = 0; k < 3; ++k) {
+				float e = evaluate(tri.edge[k], px, py);
+				inside = inside && (e > 0.0f || (e == 0.0f && tri.topLeft[k] != 0));
+			}
+			if (!inside) {
+				continue;
+			}
+
+			float depth = evaluate(tri.depth, px, py);
+			if (!(depth < depthRow[x]) || depth > 1.0f) {
+				continue;
+			}
+			depthRow[x] = depth;
+
+			float w = 1.0f / evaluate(tri.invW, px, py);
+			colorRow[x] = (toChannel(evaluate(tri.color[3], px, py) * w) << 24)
+				| (toChannel(evaluate(tri.color[0], px, py) * w) << 16)
+				| (toChannel(evaluate(tri.color[1], px, py) * w) << 8)
+				| toChannel(evaluate(tri.color[2], px, py) * w);
+		}
+	}
+#endif
+}
+
+void SoftwareRenderer::Present() {
+	PROFILE_ZONE("Present");
+#ifdef _WIN32
+	if (!hWnd) {
+		return;
+	}
+
+	BITMAPINFO bmi{};
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = tilesX * TileSize;
+	bmi.bmiHeader.biHeight = -clientHeight; // top-down rows
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	HDC hdc = GetDC(hWnd);
+	SetDIBitsToDevice(hdc, 0, 0, clientWidth, clientHeight, 0, 0, 0, clientHeight, colorBuffer.data(), &bmi, DIB_RGB_COLORS);
+	ReleaseDC(hWnd, hdc);
+
+	// GDI has no swap interval, wait for the compositor instead
+	if (pOpts && pOpts->vSync) {
+		DwmFlush();
+	}
+#endif
+}
\ No newline at end of file
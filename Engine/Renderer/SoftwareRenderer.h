@@ -0,0 +1,103 @@
+//
+// Software Renderer
+// CPU tile-binned rasterizer, used where no GPU is available
+// Triangles are transformed and binned in DrawMesh, tiles are
+// shaded in parallel on the job system in EndFrame
+//
+
+#pragma once
+#include "IRenderer.h"
+#include "StateCache.h"
+#include "Engine/Memory/FrameArena.h"
+#include <cstdint>
+#include <vector>
+
+class SoftwareRenderer : public IRenderer {
+public:
+	SoftwareRenderer() = default;
+	~SoftwareRenderer() override;
+
+	bool Initialize(NativeWindow hWnd, RendererOptions* pRendererOptions) override;
+	bool CompileShaders() override;
+	void Shutdown() override;
+	void OnResize(int width, int height) override;
+
+	float AspectRatio() const override;
+
+	MeshHandle CreateMesh(const MeshData& data) override;
+	bool UpdateMesh(MeshHandle mesh, const MeshData& data) override;
+	void DestroyMesh(MeshHandle mesh) override;
+
+	void BeginFrame(const Camera& camera) override;
+	void EndFrame() override;
+
+	void ClearBackground(ColorRGB color) override;
+	void DrawRect(Rect rect, ColorRGB color) override;
+	void DrawFilledRect(Rect rect, ColorRGB color, float thickness) override;
+	void DrawLine(Vec2 pos, ColorRGB color, float thickness) override;
+
+	void DrawMesh(MeshHandle mesh, const Mat4& world, uint32_t lod) override;
+
+	RenderStats GetRenderStats() const override { return stats.LastFrame(); }
+private:
+	static constexpr int TileSize = 64;
+
+	// clip space position and color of a transformed vertex
+	struct ClipVertex {
+		float x, y, z, w;
+		float r, g, b, a;
+	};
+
+	// screen space plane equation: value(px, py) = a * px + b * py + c
+	struct Plane {
+		float a, b, c;
+	};
+
+	// everything a tile needs to rasterize one triangle
+	struct Triangle {
+		Plane edge[3];
+		uint32_t topLeft[3]; // all bits set if the edge owns pixels lying exactly on it
+		Plane depth;      // z/w, affine in screen space
+		Plane invW;       // 1/w, for perspective correct attributes
+		Plane color[4];   // rgba/w
+		int32_t minX, minY, maxX, maxY;
+	};
+
+	NativeWindow hWnd{};
+	int clientWidth{}, clientHeight{};
+	RendererOptions* pOpts{ nullptr };
+	Mat4 viewProj{}; // captured from the camera in BeginFrame
+
+	int tilesX{}, tilesY{};
+	std::vector<uint32_t> colorBuffer{}; // BGRA8, row-major
+	std::vector<float> depthBuffer{};
+	uint32_t clearColor{ 0xFF000000 };
+
+	// positions are split out so TransformPoints can stream them
+	struct Mesh {
+		std::vector<Vec3> positions{};
+		std::vector<Vec4> colors{};
+		std::vector<uint32_t> indices{};
+		std::vector<MeshLod> lods{}; // index ranges, finest first
+	};
+	std::vector<Mesh> meshes{}; // indexed by MeshHandle
+	std::vector<Vec4> transformed{};
+	std::vector<ClipVertex> clipVertices{};
+
+	std::vector<Triangle> triangles{};
+	// rebuilt empty every frame out of binArena, so bins growing as the view changes never touch the heap
+	FrameArena binArena{};
+	std::vector<FrameVector<uint32_t>> tileBins{};
+
+	// only for its per-frame draw and triangle counts, there is no device state to bind
+	StateCache stats{};
+
+	void ResizeBuffers(int width, int height);
+	void ClipAndSetup(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2);
+	void SetupTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2);
+
+	void RasterizeTiles();
+	void RasterizeTile(int tileIndex);
+	void RasterizeTriangle(const Triangle& tri, int x0, int y0, int x1, int y1);
+	void Present();
+};
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "StateCache.h"
+
+bool StateCache::Bind(StateSlot slot, uint64_t value) {
+	uint64_t& current = bound[static_cast<size_t>(slot)];
+	if (current == value) {
+		++frame.redundantBinds;
+		return false;
+	}
+	current = value;
+	++frame.binds;
+	return true;
+}
+
+void StateCache::Invalidate() {
+	bound.fill(Unbound);
+}
+
+void StateCache::EndFrame() {
+	lastDraws.store(frame.draws, std::memory_order_relaxed);
+	lastTriangles.store(frame.triangles, std::memory_order_relaxed);
+	lastBinds.store(frame.binds, std::memory_order_relaxed);
+	lastRedundantBinds.store(frame.redundantBinds, std::memory_order_relaxed);
+	frame = {};
+}
+
+RenderStats StateCache::LastFrame() const {
+	return {
+		lastDraws.load(std::memory_order_relaxed),
+		lastTriangles.load(std::memory_order_relaxed),
+		lastBinds.load(std::memory_order_relaxed),
+		lastRedundantBinds.load(std::memory_order_relaxed) };
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+//
+// State Cache
+// Remembers the value bound on every pipeline slot of a backend and filters
+// out binds of what is already there: backends call Bind before touching the
+// device and only issue the call when it returns true
+// Batches are drawn in DrawKey order so the most expensive state changes the
+// fewest times; bind and draw counts of the last frame are kept for the stats
+//
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "IRenderer.h"
+
+enum class StateSlot : uint8_t {
+	VertexShader,
+	PixelShader,
+	InputLayout,
+	Topology,
+	Rasterizer,
+	VertexBuffer,
+	InstanceBuffer,
+	InstanceOffset,
+	IndexBuffer,
+	RenderTarget,
+	DepthTarget,
+	Count,
+};
+
+// sort key of a draw batch, most expensive state in the highest bits:
+// pipeline (shaders and input layout, 16 bits) | rasterizer state (8) | mesh (32) | level of detail (8)
+namespace DrawKey {
+	inline constexpr int LodBits = 8;
+	inline constexpr int MeshBits = 32;
+	inline constexpr int RasterizerBits = 8;
+
+	constexpr uint64_t Make(uint32_t pipeline, uint32_t rasterizer, MeshHandle mesh, uint32_t lod) {
+		return (static_cast<uint64_t>(pipeline) << (LodBits + MeshBits + RasterizerBits))
+			| (static_cast<uint64_t>(rasterizer & ((1u << RasterizerBits) - 1)) << (LodBits + MeshBits))
+			| (static_cast<uint64_t>(mesh) << LodBits)
+			| (lod & ((1u << LodBits) - 1));
+	}
+	constexpr MeshHandle Mesh(uint64_t key) { return static_cast<MeshHandle>(key >> LodBits); }
+	constexpr uint32_t Lod(uint64_t key) { return static_cast<uint32_t>(key & ((1u << LodBits) - 1)); }
+}
+
+class StateCache {
+public:
+	StateCache() { Invalidate(); }
+
+	// true if value differs from what slot holds, the caller then binds it on the device
+	bool Bind(StateSlot slot, uint64_t value);
+	template <typename T>
+	bool Bind(StateSlot slot, T* object) { return Bind(slot, reinterpret_cast<uintptr_t>(object)); }
+
+	void CountDraw(uint32_t triangles) { ++frame.draws; frame.triangles += triangles; }
+
+	// forget everything, for when state was bound without the cache or the device was reset
+	void Invalidate();
+	// forget one slot, e.g. the render target a flip model swap chain unbinds on Present
+	void Invalidate(StateSlot slot) { bound[static_cast<size_t>(slot)] = Unbound; }
+	// publishes this frame's counts and starts the next frame
+	void EndFrame();
+	// counts of the last finished frame, safe to read from any thread
+	RenderStats LastFrame() const;
+private:
+	static constexpr uint64_t Unbound = UINT64_MAX;
+
+	std::array<uint64_t, static_cast<size_t>(StateSlot::Count)> bound{};
+	RenderStats frame{};
+
+	std::atomic<uint32_t> lastDraws{ 0 };
+	std::atomic<uint32_t> lastTriangles{ 0 };
+	std::atomic<uint32_t> lastBinds{ 0 };
+	std::atomic<uint32_t> lastRedundantBinds{ 0 };
+};
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "UploadRing.h"
+
+void UploadRing::Reset(size_t capacity) {
+	this->capacity = capacity;
+	head = 0;
+	tail = 0;
+	allocated = 0;
+	retired = 0;
+	firstFrame = 0;
+	frameCount = 0;
+}
+
+size_t UploadRing::Allocate(size_t size, size_t alignment) {
+	if (size == 0 || size > capacity) {
+		return InvalidOffset;
+	}
+	if (Used() == 0) {
+		// nothing live, start over at the front so the whole buffer is one free block;
+		// frames still waiting to retire allocated nothing, so they end at the new start too
+		for (size_t i = 0; i < frameCount; ++i) {
+			frames[(firstFrame + i) % frames.size()].head = 0;
+		}
+		tail = 0;
+		head = size;
+		allocated += size;
+		return 0;
+	}
+
+	const size_t aligned = (head + alignment - 1) & ~(alignment - 1);
+	if (head > tail) {
+		// free space is [head, capacity) followed by [0, tail)
+		if (aligned + size <= capacity) {
+			allocated += aligned + size - head;
+			head = aligned + size;
+			return aligned;
+		}
+		// skip the end, offset 0 is aligned for every alignment
+		if (size <= tail) {
+			allocated += capacity - head + size;
+			head = size;
+			return 0;
+		}
+		return InvalidOffset;
+	}
+
+	// wrapped already (or exactly full), free space is [head, tail)
+	if (aligned + size <= tail) {
+		allocated += aligned + size - head;
+		head = aligned + size;
+		return aligned;
+	}
+	return InvalidOffset;
+}
+
+bool UploadRing::EndFrame(uint64_t frame) {
+	if (frameCount == frames.size()) {
+		return false;
+	}
+	frames[(firstFrame + frameCount) % frames.size()] = { frame, head, allocated };
+	++frameCount;
+	return true;
+}
+
+void UploadRing::Retire(uint64_t completedFrame) {
+	while (frameCount > 0) {
+		const FrameMark& mark = frames[firstFrame];
+		if (mark.frame > completedFrame) {
+			break;
+		}
+		tail = mark.head;
+		retired = mark.allocated;
+		firstFrame = (firstFrame + 1) % frames.size();
+		--frameCount;
+	}
+}
+
+void UploadRing::Discard() {
+	head = 0;
+	tail = 0;
+	retired = allocated;
+	firstFrame = 0;
+	frameCount = 0;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+//
+// Upload Ring
+// Sub-allocates slices of one persistently allocated GPU upload buffer
+// Only offsets are tracked, the backend owns the memory and maps it, so the
+// same ring serves a D3D11 dynamic buffer or a fenced D3D12/Vulkan heap
+//
+// Slices are handed out front to back and wrap around to the start once the
+// end is reached. Backends with fences call EndFrame after recording a frame and
+// Retire once the GPU finished it; D3D11 maps with NO_OVERWRITE while Allocate
+// succeeds and with DISCARD followed by Discard when it does not
+//
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class UploadRing {
+public:
+	static constexpr size_t InvalidOffset = SIZE_MAX;
+	// frames that can be recorded but not retired yet, EndFrame beyond that fails
+	static constexpr size_t MaxFramesInFlight = 8;
+
+	explicit UploadRing(size_t capacity = 0) { Reset(capacity); }
+
+	// forgets every slice and frame, e.g. after the buffer was recreated with a new size
+	void Reset(size_t capacity);
+
+	// offset of size bytes aligned to alignment (a power of two), InvalidOffset if that
+	// would overwrite a slice the GPU may still read or size exceeds the capacity
+	size_t Allocate(size_t size, size_t alignment);
+
+	// everything allocated since the previous EndFrame belongs to frame
+	bool EndFrame(uint64_t frame);
+	// frees the slices of every frame up to and including completedFrame
+	void Retire(uint64_t completedFrame);
+	// frees every slice at once, for when the buffer contents were thrown away (D3D11 map discard)
+	void Discard();
+
+	size_t Capacity() const { return capacity; }
+	// bytes in live slices, including alignment padding and the skipped end before a wrap
+	size_t Used() const { return static_cast<size_t>(allocated - retired); }
+private:
+	struct FrameMark {
+		uint64_t frame;
+		size_t head;        // where the frame's last slice ended
+		uint64_t allocated; // running total at that point
+	};
+
+	size_t capacity{};
+	size_t head{}; // next free byte
+	size_t tail{}; // oldest live byte
+	// running byte totals, their difference is what is in use, so a full ring and an empty one never look alike
+	uint64_t allocated{};
+	uint64_t retired{};
+
+	std::array<FrameMark, MaxFramesInFlight> frames{};
+	size_t firstFrame{};
+	size_t frameCount{};
+};
\ No newline at end of file
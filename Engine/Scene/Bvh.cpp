@@ -0,0 +1,282 @@
+#include "Bvh.h"
+#include <algorithm>
+#include <cmath>
+
+/* build */
+void Bvh::Build(const Aabb* boxes, uint32_t count) {
+	Clear();
+	if (count == 0) {
+		return;
+	}
+
+	mBoxes.assign(boxes, boxes + count);
+	mIndices.resize(count);
+	std::vector<Vec3> centers(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		mIndices[i] = i;
+		centers[i] = boxes[i].Center();
+	}
+
+	// a binary tree with leaves of at least one primitive never has more than 2n - 1 nodes
+	mNodes.reserve(2 * static_cast<size_t>(count) - 1);
+	BuildNode(0, count, centers, 0);
+	mBuiltArea = mNodes[0].bounds.HalfArea();
+}
+
+uint32_t Bvh::BuildNode(uint32_t first, uint32_t count, const std::vector<Vec3>& centers, uint32_t depth) {
+	const uint32_t nodeIndex = static_cast<uint32_t>(mNodes.size());
+	mNodes.push_back({});
+
+	Aabb bounds{};
+	for (uint32_t i = first; i < first + count; ++i) {
+		bounds.Grow(mBoxes[mIndices[i]]);
+	}
+	mNodes[nodeIndex].bounds = bounds;
+
+	int axis{};
+	float position{};
+	if (count <= MaxLeafSize || depth + 1 >= MaxDepth || !FindSplit(first, count, bounds, centers, axis, position)) {
+		mNodes[nodeIndex].offset = first;
+		mNodes[nodeIndex].count = count;
+		return nodeIndex;
+	}
+
+	uint32_t* begin = mIndices.data() + first;
+	uint32_t* middle = std::partition(begin, begin + count, [&](uint32_t i) { return (&centers[i].x)[axis] < position; });
+	uint32_t leftCount = static_cast<uint32_t>(middle - begin);
+	if (leftCount == 0 || leftCount == count) {
+		// every center in one bin, fall back to a median split
+		leftCount = count / 2;
+		std::nth_element(begin, begin + leftCount, begin + count,
+			[&](uint32_t a, uint32_t b) { return (&centers[a].x)[axis] < (&centers[b].x)[axis]; });
+	}
+
+	BuildNode(first, leftCount, centers, depth + 1);
+	const uint32_t right = BuildNode(first + leftCount, count - leftCount, centers, depth + 1);
+	mNodes[nodeIndex].offset = right;
+	mNodes[nodeIndex].count = 0;
+	return nodeIndex;
+}
+
+// binned surface area heuristic, false when no split beats a leaf
+bool Bvh::FindSplit(uint32_t first, uint32_t count, const Aabb& bounds, const std::vector<Vec3>& centers,
+	int& axis, float& position) const {
+	Aabb centerBounds{};
+	for (uint32_t i = first; i < first + count; ++i) {
+		centerBounds.Grow(centers[mIndices[i]]);
+	}
+
+	float bestCost = static_cast<float>(count) * bounds.HalfArea();
+	bool found{ false };
+	for (int a = 0; a < 3; ++a) {
+		const float lo = (&centerBounds.min.x)[a];
+		const float hi = (&centerBounds.max.x)[a];
+		if (hi <= lo) {
+			continue;
+		}
+
+		struct Bin {
+			Aabb bounds;
+			uint32_t count;
+		};
+		Bin bins[BinCount]{};
+		const float scale = static_cast<float>(BinCount) / (hi - lo);
+		for (uint32_t i = first; i < first + count; ++i) {
+			const uint32_t primitive = mIndices[i];
+			const uint32_t bin = std::min(BinCount - 1, static_cast<uint32_t>(((&centers[primitive].x)[a] - lo) * scale));
+			bins[bin].bounds.Grow(mBoxes[primitive]);
+			++bins[bin].count;
+		}
+
+		// sweep from both sides, leftArea[i] covers bins 0..i
+		float leftArea[BinCount - 1]{};
+		uint32_t leftCount[BinCount - 1]{};
+		Aabb sweep{};
+		uint32_t sweepCount{ 0 };
+		for (uint32_t i = 0; i < BinCount - 1; ++i) {
+			sweep.Grow(bins[i].bounds);
+			sweepCount += bins[i].count;
+			leftArea[i] = sweep.HalfArea();
+			leftCount[i] = sweepCount;
+		}
+		sweep = {};
+		sweepCount = 0;
+		for (uint32_t i = BinCount - 1; i > 0; --i) {
+			sweep.Grow(bins[i].bounds);
+			sweepCount += bins[i].count;
+			const float cost = leftArea[i - 1] * static_cast<float>(leftCount[i - 1]) + sweep.HalfArea() * static_cast<float>(sweepCount);
+			if (cost < bestCost) {
+				bestCost = cost;
+				axis = a;
+				position = lo + static_cast<float>(i) / scale;
+				found = true;
+			}
+		}
+	}
+	return found;
+}
+
+void Bvh::Refit(const Aabb* boxes) {
+	if (mNodes.empty()) {
+		return;
+	}
+	mBoxes.assign(boxes, boxes + mBoxes.size());
+
+	// children always come after their parent, so walking backwards visits them first
+	for (size_t n = mNodes.size(); n-- > 0;) {
+		Node& node = mNodes[n];
+		if (node.count > 0) {
+			Aabb bounds{};
+			for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+				bounds.Grow(mBoxes[mIndices[i]]);
+			}
+			node.bounds = bounds;
+		}
+		else {
+			node.bounds = Union(mNodes[n + 1].bounds, mNodes[node.offset].bounds);
+		}
+	}
+}
+
+void Bvh::Clear() {
+	mNodes.clear();
+	mIndices.clear();
+	mBoxes.clear();
+	mBuiltArea = 0.0f;
+}
+
+float Bvh::Degradation() const {
+	if (mNodes.empty() || mBuiltArea <= 0.0f) {
+		return 1.0f;
+	}
+	return mNodes[0].bounds.HalfArea() / mBuiltArea;
+}
+
+/* queries */
+bool Bvh::RayCast(const Ray& ray, float maxDistance, BvhRayHit& hit) const {
+	if (mNodes.empty()) {
+		return false;
+	}
+
+	const RayInv inv{ ray };
+	float closest = maxDistance;
+	hit.primitive = UINT32_MAX;
+
+	uint32_t stack[MaxDepth * 2];
+	uint32_t stackSize{ 0 };
+	if (Intersect(inv, mNodes[0].bounds, closest) >= 0.0f) {
+		stack[stackSize++] = 0;
+	}
+
+	while (stackSize > 0) {
+		const uint32_t nodeIndex = stack[--stackSize];
+		const Node& node = mNodes[nodeIndex];
+		if (node.count > 0) {
+			for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+				const float t = Intersect(inv, mBoxes[mIndices[i]], closest);
+				if (t >= 0.0f && (t < closest || hit.primitive == UINT32_MAX)) {
+					closest = t;
+					hit.primitive = mIndices[i];
+				}
+			}
+			continue;
+		}
+
+		// visit the nearer child first so the far one is likely culled by a closer hit
+		const uint32_t left = nodeIndex + 1;
+		const uint32_t right = node.offset;
+		float tLeft = Intersect(inv, mNodes[left].bounds, closest);
+		float tRight = Intersect(inv, mNodes[right].bounds, closest);
+		if (tLeft >= 0.0f && tRight >= 0.0f) {
+			if (tLeft < tRight) {
+				stack[stackSize++] = right;
+				stack[stackSize++] = left;
+			}
+			else {
+				stack[stackSize++] = left;
+				stack[stackSize++] = right;
+			}
+		}
+		else if (tLeft >= 0.0f) {
+			stack[stackSize++] = left;
+		}
+		else if (tRight >= 0.0f) {
+			stack[stackSize++] = right;
+		}
+	}
+
+	hit.distance = closest;
+	return hit.primitive != UINT32_MAX;
+}
+
+void Bvh::Overlap(const Aabb& box, std::vector<uint32_t>& out) const {
+	if (mNodes.empty()) {
+		return;
+	}
+
+	uint32_t stack[MaxDepth * 2];
+	uint32_t stackSize{ 0 };
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const uint32_t nodeIndex = stack[--stackSize];
+		const Node& node = mNodes[nodeIndex];
+		if (!node.bounds.Overlaps(box)) {
+			continue;
+		}
+		if (node.count > 0) {
+			for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+				if (mBoxes[mIndices[i]].Overlaps(box)) {
+					out.push_back(mIndices[i]);
+				}
+			}
+			continue;
+		}
+		stack[stackSize++] = node.offset;
+		stack[stackSize++] = nodeIndex + 1;
+	}
+}
+
+bool Bvh::Nearest(const Vec3& point, float maxDistance, BvhRayHit& hit) const {
+	if (mNodes.empty()) {
+		return false;
+	}
+
+	float closest = maxDistance * maxDistance;
+	hit.primitive = UINT32_MAX;
+
+	uint32_t stack[MaxDepth * 2];
+	uint32_t stackSize{ 0 };
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const uint32_t nodeIndex = stack[--stackSize];
+		const Node& node = mNodes[nodeIndex];
+		if (node.bounds.DistanceSquared(point) > closest) {
+			continue;
+		}
+		if (node.count > 0) {
+			for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+				const float d = mBoxes[mIndices[i]].DistanceSquared(point);
+				if (d <= closest) {
+					closest = d;
+					hit.primitive = mIndices[i];
+				}
+			}
+			continue;
+		}
+
+		// closer child on top of the stack
+		const uint32_t left = nodeIndex + 1;
+		const uint32_t right = node.offset;
+		if (mNodes[left].bounds.DistanceSquared(point) < mNodes[right].bounds.DistanceSquared(point)) {
+			stack[stackSize++] = right;
+			stack[stackSize++] = left;
+		}
+		else {
+			stack[stackSize++] = left;
+			stack[stackSize++] = right;
+		}
+	}
+
+	hit.distance = std::sqrt(closest);
+	return hit.primitive != UINT32_MAX;
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+//
+// Bounding Volume Hierarchy
+// Binned SAH build over a set of boxes, flattened depth first into 32 byte nodes:
+// an inner node's left child is the next node and its right child is stored,
+// a leaf stores a range of primitive indices
+// Moving primitives only need Refit, which is a single reverse pass over the nodes
+//
+
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Util/Math/Aabb.h"
+
+struct BvhRayHit {
+	uint32_t primitive{ UINT32_MAX };
+	float distance{};
+};
+
+class Bvh {
+public:
+	Bvh() = default;
+
+	// primitive i is boxes[i], queries report these indices
+	void Build(const Aabb* boxes, uint32_t count);
+	// same primitives with new boxes, the tree shape is kept
+	void Refit(const Aabb* boxes);
+	void Clear();
+
+	uint32_t PrimitiveCount() const { return static_cast<uint32_t>(mIndices.size()); }
+	uint32_t NodeCount() const { return static_cast<uint32_t>(mNodes.size()); }
+	// how much refits have loosened the tree, root area over the area right after the build
+	float Degradation() const;
+
+	/* queries */
+	// closest primitive box along the ray within maxDistance
+	bool RayCast(const Ray& ray, float maxDistance, BvhRayHit& hit) const;
+	// appends every primitive whose box overlaps box
+	void Overlap(const Aabb& box, std::vector<uint32_t>& out) const;
+	// closest primitive box to point within maxDistance, distance is zero inside a box
+	bool Nearest(const Vec3& point, float maxDistance, BvhRayHit& hit) const;
+private:
+	struct Node {
+		Aabb bounds;
+		uint32_t offset; // right child for inner nodes, first index for leaves
+		uint32_t count;  // zero for inner nodes
+	};
+	static_assert(sizeof(Node) == 32, "two nodes per cache line");
+
+	static constexpr uint32_t MaxLeafSize = 4;
+	static constexpr uint32_t BinCount = 12;
+	static constexpr uint32_t MaxDepth = 64;
+
+	std::vector<Node> mNodes{};
+	std::vector<uint32_t> mIndices{};
+	std::vector<Aabb> mBoxes{};     // copy of the input, queries test primitives against it
+	float mBuiltArea{};
+
+	uint32_t BuildNode(uint32_t first, uint32_t count, const std::vector<Vec3>& centers, uint32_t depth);
+	bool FindSplit(uint32_t first, uint32_t count, const Aabb& bounds, const std::vector<Vec3>& centers,
+		int& axis, float& position) const;
+};
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "BvhBenchmark.h"
+#include "Bvh.h"
+#include "Util/Log.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	// average distance between box centers, boxes have extents of 0.1 to 0.5
+	constexpr float Spacing = 2.0f;
+	constexpr uint32_t Queries = 1000;
+	// slab tests of the brute force scan per size, it gets only as many queries as fit
+	constexpr uint64_t BruteForceBudget = 20'000'000;
+	constexpr uint32_t Seed = 12345;
+
+	double Milliseconds(Clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	bool BruteRayCast(const std::vector<Aabb>& boxes, const Ray& ray, float maxDistance, BvhRayHit& hit) {
+		const RayInv inv{ ray };
+		hit = {};
+		float closest = maxDistance;
+		for (uint32_t i = 0; i < boxes.size(); ++i) {
+			const float distance = Intersect(inv, boxes[i], closest);
+			if (distance >= 0.0f && (hit.primitive == UINT32_MAX || distance < closest)) {
+				closest = distance;
+				hit = { i, distance };
+			}
+		}
+		return hit.primitive != UINT32_MAX;
+	}
+
+	void BruteOverlap(const std::vector<Aabb>& boxes, const Aabb& box, std::vector<uint32_t>& out) {
+		for (uint32_t i = 0; i < boxes.size(); ++i) {
+			if (boxes[i].Overlaps(box)) {
+				out.push_back(i);
+			}
+		}
+	}
+
+	bool RunSize(uint32_t count) {
+		std::mt19937 random{ Seed };
+		const float side = Spacing * std::cbrt(static_cast<float>(count));
+		std::uniform_real_distribution<float> position{ 0.0f, side };
+		std::uniform_real_distribution<float> extent{ 0.1f, 0.5f };
+		std::uniform_real_distribution<float> unit{ -1.0f, 1.0f };
+
+		std::vector<Aabb> boxes(count);
+		for (Aabb& box : boxes) {
+			box = Aabb::FromCenterExtents({ position(random), position(random), position(random) },
+				{ extent(random), extent(random), extent(random) });
+		}
+
+		Bvh bvh{};
+		Clock::time_point start = Clock::now();
+		bvh.Build(boxes.data(), count);
+		const double buildMs = Milliseconds(start);
+
+		// every box moves a little, like a frame of simulation
+		for (Aabb& box : boxes) {
+			const Vec3 offset{ unit(random) * 0.25f, unit(random) * 0.25f, unit(random) * 0.25f };
+			box = { box.min + offset, box.max + offset };
+		}
+		start = Clock::now();
+		bvh.Refit(boxes.data());
+		const double refitMs = Milliseconds(start);
+
+		std::vector<Ray> rays(Queries);
+		for (Ray& ray : rays) {
+			ray.origin = { position(random), position(random), position(random) };
+			ray.direction = Normalize(Vec3{ unit(random), unit(random), unit(random) });
+		}
+		std::vector<Aabb> regions(Queries);
+		for (Aabb& region : regions) {
+			region = Aabb::FromCenterExtents({ position(random), position(random), position(random) }, Vec3{ Spacing * 2.0f });
+		}
+		const uint32_t bruteQueries = static_cast<uint32_t>(std::clamp<uint64_t>(BruteForceBudget / count, 1, Queries));
+
+		/* ray casts */
+		std::vector<BvhRayHit> hits(Queries);
+		uint32_t hitCount{ 0 };
+		start = Clock::now();
+		for (uint32_t i = 0; i < Queries; ++i) {
+			hitCount += bvh.RayCast(rays[i], side, hits[i]) ? 1 : 0;
+		}
+		const double bvhRayUs = Milliseconds(start) * 1000.0 / Queries;
+
+		start = Clock::now();
+		for (uint32_t i = 0; i < bruteQueries; ++i) {
+			BvhRayHit hit{};
+			const bool found = BruteRayCast(boxes, rays[i], side, hit);
+			// ties between boxes at the same distance may pick either, the distance has to agree
+			if (found != (hits[i].primitive != UINT32_MAX) || (found && std::abs(hit.distance - hits[i].distance) > 1e-4f)) {
+				Log.error("[Bench] BVH ray cast " + std::to_string(i) + " disagrees with the brute force scan");
+				return false;
+			}
+		}
+		const double bruteRayUs = Milliseconds(start) * 1000.0 / bruteQueries;
+
+		/* overlaps */
+		std::vector<uint32_t> found{};
+		std::vector<uint32_t> expected{};
+		size_t overlapCount{ 0 };
+		start = Clock::now();
+		for (const Aabb& region : regions) {
+			found.clear();
+			bvh.Overlap(region, found);
+			overlapCount += found.size();
+		}
+		const double bvhOverlapUs = Milliseconds(start) * 1000.0 / Queries;
+
+		double bruteOverlapUs{ 0.0 };
+		for (uint32_t i = 0; i < bruteQueries; ++i) {
+			expected.clear();
+			start = Clock::now();
+			BruteOverlap(boxes, regions[i], expected);
+			bruteOverlapUs += Milliseconds(start) * 1000.0;
+
+			found.clear();
+			bvh.Overlap(regions[i], found);
+			std::sort(found.begin(), found.end());
+			if (found != expected) {
+				Log.error("[Bench] BVH overlap " + std::to_string(i) + " disagrees with the brute force scan");
+				return false;
+			}
+		}
+		bruteOverlapUs /= bruteQueries;
+
+		std::ostringstream oss{};
+		oss.precision(4);
+		oss << "[Bench] " << count << " boxes: build " << buildMs << " ms, refit " << refitMs << " ms ("
+			<< bvh.NodeCount() << " nodes, degradation " << bvh.Degradation() << ")";
+		Log.info(oss.str());
+		oss.str("");
+		oss << "[Bench]   ray cast " << bvhRayUs << " us vs brute force " << bruteRayUs << " us (" << bruteRayUs / bvhRayUs
+			<< "x, " << hitCount << "/" << Queries << " hit)";
+		Log.info(oss.str());
+		oss.str("");
+		oss << "[Bench]   overlap " << bvhOverlapUs << " us vs brute force " << bruteOverlapUs << " us (" << bruteOverlapUs / bvhOverlapUs
+			<< "x, " << static_cast<double>(overlapCount) / Queries << " boxes per query)";
+		Log.info(oss.str());
+		return true;
+	}
+}
+
+bool RunBvhBenchmark(uint32_t count) {
+	const uint32_t defaultCounts[] = { 10'000, 100'000, 1'000'000 };
+	if (count > 0) {
+		return RunSize(count);
+	}
+	for (uint32_t size : defaultCounts) {
+		if (!RunSize(size)) {
+			return false;
+		}
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+//
+// BVH Benchmark
+// -bench-bvh: build and refit times of the scene BVH and the cost of its ray casts and
+// overlap queries against a brute force scan over the same boxes, on a random scene
+// of uniformly spread boxes whose volume grows with the count so the density stays the same
+//
+
+#pragma once
+#include <cstdint>
+
+// count 0 runs 10k, 100k and 1M boxes
+bool RunBvhBenchmark(uint32_t count = 0);
\ No newline at end of file
@@ -0,0 +1,372 @@
+#include "Scene.h"
+#include "Engine/Jobs/JobSystem.h"
+#include "Engine/Profiler/Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace {
+	// the unit cube every backend ships
+	constexpr Vec3 UnitCubeExtents{ 0.5f, 0.5f, 0.5f };
+
+	// refits only grow the tree, rebuild once the root got this much larger than when it was built
+	constexpr float MaxBvhDegradation = 2.0f;
+
+	// a level is used while its error projects to at most this many pixels
+	constexpr float LodPixelError = 1.0f;
+	// coarser levels have to fit this fraction below the threshold, so objects sitting at the
+	// switch distance do not flip between levels every frame
+	constexpr float LodHysteresis = 0.25f;
+}
+
+void Scene::Reserve(size_t count) {
+	mPositions.reserve(count);
+	mRotations.reserve(count);
+	mScalings.reserve(count);
+	mWorlds.reserve(count);
+	mMeshes.reserve(count);
+	mDirty.reserve(count);
+	mDenseToSlot.reserve(count);
+	mBoundsX.reserve(count);
+	mBoundsY.reserve(count);
+	mBoundsZ.reserve(count);
+	mBoundsRadius.reserve(count);
+	mVisible.reserve(count);
+	mLods.reserve(count);
+	mWorldBoxes.reserve(count);
+}
+
+void Scene::SetMeshBounds(MeshHandle mesh, const Vec3& center, const Vec3& extents) {
+	if (mesh >= mMeshBounds.size()) {
+		mMeshBounds.resize(mesh + 1, { { 0.0f, 0.0f, 0.0f }, UnitCubeExtents });
+	}
+	mMeshBounds[mesh] = { center, extents };
+
+	for (uint32_t i = 0; i < mMeshes.size(); ++i) {
+		if (mMeshes[i] == mesh) {
+			MarkDirty(i);
+		}
+	}
+}
+
+void Scene::SetMeshLods(MeshHandle mesh, const MeshLod* lods, uint32_t lodCount) {
+	if (mesh >= mMeshLods.size()) {
+		mMeshLods.resize(mesh + 1, { 1, {} });
+	}
+	MeshLods& entry = mMeshLods[mesh];
+	entry.count = std::clamp(lodCount, 1u, MaxMeshLods);
+	for (uint32_t level = 0; level < MaxMeshLods; ++level) {
+		entry.errors[level] = level < lodCount ? lods[level].error : 0.0f;
+	}
+	entry.errors[0] = 0.0f;
+
+	// the old level may not exist anymore
+	for (uint32_t i = 0; i < mMeshes.size(); ++i) {
+		if (mMeshes[i] == mesh) {
+			mLods[i] = static_cast<uint8_t>(std::min<uint32_t>(mLods[i], entry.count - 1));
+		}
+	}
+}
+
+void Scene::Clear() {
+	// bump every live generation so outstanding handles go stale
+	for (uint32_t slot : mDenseToSlot) {
+		++mSlots[slot].generation;
+		mSlots[slot].dense = mFreeSlot;
+		mFreeSlot = slot;
+	}
+	mPositions.clear();
+	mRotations.clear();
+	mScalings.clear();
+	mWorlds.clear();
+	mMeshes.clear();
+	mDirty.clear();
+	mDenseToSlot.clear();
+	mDirtyCount = 0;
+	mBoundsX.clear();
+	mBoundsY.clear();
+	mBoundsZ.clear();
+	mBoundsRadius.clear();
+	mVisible.clear();
+	mVisibleCount = 0;
+	mLods.clear();
+	mWorldBoxes.clear();
+	mBvhRebuild = true;
+}
+
+/* entities */
+EntityHandle Scene::Create(MeshHandle mesh, const Vec3& position, const Vec3& rotation, const Vec3& scaling) {
+	const uint32_t dense = static_cast<uint32_t>(mMeshes.size());
+
+	uint32_t slot{};
+	if (mFreeSlot != UINT32_MAX) {
+		slot = mFreeSlot;
+		mFreeSlot = mSlots[slot].dense;
+	}
+	else {
+		slot = static_cast<uint32_t>(mSlots.size());
+		mSlots.push_back({ 0, 0 });
+	}
+	mSlots[slot].dense = dense;
+
+	mPositions.push_back(position);
+	mRotations.push_back(rotation);
+	mScalings.push_back(scaling);
+	mWorlds.push_back(Mat4::Identity());
+	mMeshes.push_back(mesh);
+	mDirty.push_back(0);
+	mDenseToSlot.push_back(slot);
+	mBoundsX.push_back(position.x);
+	mBoundsY.push_back(position.y);
+	mBoundsZ.push_back(position.z);
+	mBoundsRadius.push_back(0.0f);
+	mVisible.push_back(1);
+	++mVisibleCount;
+	mLods.push_back(0);
+	mWorldBoxes.push_back({});
+	mBvhRebuild = true;
+	MarkDirty(dense);
+
+	return { slot, mSlots[slot].generation };
+}
+
+bool Scene::Destroy(EntityHandle entity) {
+	if (!IsAlive(entity)) {
+		return false;
+	}
+
+	const uint32_t dense = mSlots[entity.index].dense;
+	const uint32_t last = static_cast<uint32_t>(mMeshes.size()) - 1;
+	if (mDirty[dense]) {
+		--mDirtyCount;
+	}
+	if (mVisible[dense]) {
+		--mVisibleCount;
+	}
+
+	// keep the pools packed by moving the last entity into the hole
+	if (dense != last) {
+		mPositions[dense] = mPositions[last];
+		mRotations[dense] = mRotations[last];
+		mScalings[dense] = mScalings[last];
+		mWorlds[dense] = mWorlds[last];
+		mMeshes[dense] = mMeshes[last];
+		mDirty[dense] = mDirty[last];
+		mDenseToSlot[dense] = mDenseToSlot[last];
+		mBoundsX[dense] = mBoundsX[last];
+		mBoundsY[dense] = mBoundsY[last];
+		mBoundsZ[dense] = mBoundsZ[last];
+		mBoundsRadius[dense] = mBoundsRadius[last];
+		mVisible[dense] = mVisible[last];
+		mLods[dense] = mLods[last];
+		mWorldBoxes[dense] = mWorldBoxes[last];
+		mSlots[mDenseToSlot[dense]].dense = dense;
+	}
+	mPositions.pop_back();
+	mRotations.pop_back();
+	mScalings.pop_back();
+	mWorlds.pop_back();
+	mMeshes.pop_back();
+	mDirty.pop_back();
+	mDenseToSlot.pop_back();
+	mBoundsX.pop_back();
+	mBoundsY.pop_back();
+	mBoundsZ.pop_back();
+	mBoundsRadius.pop_back();
+	mVisible.pop_back();
+	mLods.pop_back();
+	mWorldBoxes.pop_back();
+	mBvhRebuild = true;
+
+	Slot& slot = mSlots[entity.index];
+	++slot.generation;
+	slot.dense = mFreeSlot;
+	mFreeSlot = entity.index;
+	return true;
+}
+
+bool Scene::IsAlive(EntityHandle entity) const {
+	// Destroy and Clear bump the generation, so a matching generation means the slot is live
+	return entity.index < mSlots.size() && mSlots[entity.index].generation == entity.generation;
+}
+
+/* components */
+void Scene::SetPosition(EntityHandle entity, const Vec3& position) {
+	const uint32_t dense = DenseIndex(entity);
+	mPositions[dense] = position;
+	MarkDirty(dense);
+}
+
+void Scene::SetRotation(EntityHandle entity, const Vec3& rotation) {
+	const uint32_t dense = DenseIndex(entity);
+	mRotations[dense] = rotation;
+	MarkDirty(dense);
+}
+
+void Scene::SetScaling(EntityHandle entity, const Vec3& scaling) {
+	const uint32_t dense = DenseIndex(entity);
+	mScalings[dense] = scaling;
+	MarkDirty(dense);
+}
+
+void Scene::SetMesh(EntityHandle entity, MeshHandle mesh) {
+	const uint32_t dense = DenseIndex(entity);
+	mMeshes[dense] = mesh;
+	mLods[dense] = 0;
+	MarkDirty(dense); // bounds depend on the mesh
+}
+
+void Scene::MarkDirty(uint32_t dense) {
+	if (!mDirty[dense]) {
+		mDirty[dense] = 1;
+		++mDirtyCount;
+	}
+}
+
+/* passes */
+void Scene::UpdateTransforms() {
+	if (mDirtyCount == 0) {
+		return;
+	}
+	PROFILE_ZONE("Update Transforms");
+
+	// entities are independent, split the pools across the job system
+	constexpr uint32_t grainSize = 4096;
+	JobSystem::Get().ParallelFor(static_cast<uint32_t>(mMeshes.size()), grainSize, [this](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; ++i) {
+			if (!mDirty[i]) {
+				continue;
+			}
+			mWorlds[i] = Mat4::Scaling(mScalings[i]) * Mat4::RotationRollPitchYaw(mRotations[i]) * Mat4::Translation(mPositions[i]);
+
+			// sphere around the mesh box, rotation keeps the radius and scaling grows it by the largest axis
+			const MeshBounds local = mMeshes[i] < mMeshBounds.size() ? mMeshBounds[mMeshes[i]] : MeshBounds{ { 0.0f, 0.0f, 0.0f }, UnitCubeExtents };
+			const Vec4 center = TransformPoint(local.center, mWorlds[i]);
+			const Vec3& s = mScalings[i];
+			mBoundsX[i] = center.x;
+			mBoundsY[i] = center.y;
+			mBoundsZ[i] = center.z;
+			mBoundsRadius[i] = Length(local.extents) * std::max(std::abs(s.x), std::max(std::abs(s.y), std::abs(s.z)));
+			mWorldBoxes[i] = TransformAabb(local.center, local.extents, mWorlds[i]);
+			mDirty[i] = 0;
+		}
+	});
+	mDirtyCount = 0;
+	mBvhRefit = true;
+}
+
+void Scene::Cull(const Frustum& frustum, FrameVector<uint32_t>& visible) {
+	PROFILE_ZONE("Frustum Cull");
+
+	// batches are multiples of four so every job runs full SIMD lanes except the last
+	constexpr uint32_t grainSize = 8192;
+	std::atomic<size_t> visibleCount{ 0 };
+	JobSystem::Get().ParallelFor(static_cast<uint32_t>(mMeshes.size()), grainSize, [&](uint32_t begin, uint32_t end) {
+		const size_t count = end - begin;
+		CullSpheres(frustum, &mBoundsX[begin], &mBoundsY[begin], &mBoundsZ[begin], &mBoundsRadius[begin], count, &mVisible[begin]);
+
+		size_t batchVisible{ 0 };
+		for (size_t i = begin; i < end; ++i) {
+			batchVisible += mVisible[i];
+		}
+		visibleCount.fetch_add(batchVisible, std::memory_order_relaxed);
+	});
+	mVisibleCount = visibleCount.load(std::memory_order_relaxed);
+
+	// the list lives in the frame arena, one bump allocation and gone with the frame
+	visible.reserve(visible.size() + mVisibleCount);
+	const uint32_t count = static_cast<uint32_t>(mMeshes.size());
+	for (uint32_t i = 0; i < count; ++i) {
+		if (mVisible[i]) {
+			visible.push_back(i);
+		}
+	}
+}
+
+void Scene::SelectLods(const Camera& camera, float viewportHeight, const FrameVector<uint32_t>& visible) {
+	PROFILE_ZONE("Select LODs");
+
+	// pixels covered by one world unit at distance 1 along the view direction
+	const float pixelsPerUnit = 0.5f * viewportHeight / std::tan(0.5f * camera.FovY());
+	const Vec3 eye = camera.Position();
+	const float nearZ = camera.NearZ();
+
+	constexpr uint32_t grainSize = 8192;
+	JobSystem::Get().ParallelFor(static_cast<uint32_t>(visible.size()), grainSize, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t k = begin; k < end; ++k) {
+			const uint32_t i = visible[k];
+			if (mMeshes[i] >= mMeshLods.size() || mMeshLods[mMeshes[i]].count <= 1) {
+				continue;
+			}
+			const MeshLods& lods = mMeshLods[mMeshes[i]];
+
+			// the closest point of the bounding sphere gives the largest projection of the error,
+			// scaling grows the error like it grows the radius
+			const Vec3 center{ mBoundsX[i], mBoundsY[i], mBoundsZ[i] };
+			const float distance = std::max(Length(center - eye) - mBoundsRadius[i], nearZ);
+			const Vec3& s = mScalings[i];
+			const float scale = std::max(std::abs(s.x), std::max(std::abs(s.y), std::abs(s.z)));
+			const float pixelsPerError = scale * pixelsPerUnit / distance;
+
+			// refine as soon as the current level is too coarse, coarsen only once the next level is
+			// comfortably below the threshold
+			uint32_t lod = std::min<uint32_t>(mLods[i], lods.count - 1);
+			while (lod > 0 && lods.errors[lod] * pixelsPerError > LodPixelError) {
+				--lod;
+			}
+			while (lod + 1 < lods.count && lods.errors[lod + 1] * pixelsPerError <= LodPixelError * (1.0f - LodHysteresis)) {
+				++lod;
+			}
+			mLods[i] = static_cast<uint8_t>(lod);
+		}
+	});
+}
+
+void Scene::Submit(RenderCommandList& list, const FrameVector<uint32_t>& visible) const {
+	PROFILE_ZONE("Scene Submit");
+	for (uint32_t i : visible) {
+		list.DrawMesh(mMeshes[i], mWorlds[i], mLods[i]);
+	}
+}
+
+/* spatial index */
+void Scene::UpdateSpatialIndex() {
+	if (mBvhRebuild || (mBvhRefit && mBvh.Degradation() > MaxBvhDegradation)) {
+		PROFILE_ZONE("BVH Build");
+		mBvh.Build(mWorldBoxes.data(), static_cast<uint32_t>(mWorldBoxes.size()));
+	}
+	else if (mBvhRefit) {
+		PROFILE_ZONE("BVH Refit");
+		mBvh.Refit(mWorldBoxes.data());
+	}
+	mBvhRebuild = false;
+	mBvhRefit = false;
+}
+
+bool Scene::RayCast(const Ray& ray, float maxDistance, EntityHandle& entity, float& distance) const {
+	BvhRayHit hit{};
+	if (!mBvh.RayCast(ray, maxDistance, hit)) {
+		return false;
+	}
+	entity = EntityAt(hit.primitive);
+	distance = hit.distance;
+	return true;
+}
+
+void Scene::Overlap(const Aabb& box, std::vector<EntityHandle>& out) const {
+	std::vector<uint32_t> primitives{};
+	mBvh.Overlap(box, primitives);
+	for (uint32_t primitive : primitives) {
+		out.push_back(EntityAt(primitive));
+	}
+}
+
+bool Scene::Nearest(const Vec3& point, float maxDistance, EntityHandle& entity, float& distance) const {
+	BvhRayHit hit{};
+	if (!mBvh.Nearest(point, maxDistance, hit)) {
+		return false;
+	}
+	entity = EntityAt(hit.primitive);
+	distance = hit.distance;
+	return true;
+}
\ No newline at end of file
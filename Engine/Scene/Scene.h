@@ -0,0 +1,143 @@
+//
+// Scene
+// Entity/component store for everything that gets drawn
+// Components live in dense structure-of-arrays pools so passes stream through
+// contiguous memory, handles stay valid across removals thanks to a slot table
+// with generation counters, add and remove are O(1) (remove swaps with the last entity)
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Util/Math/Vectors.h"
+#include "Util/Math/Mat4.h"
+#include "Util/Math/Frustum.h"
+#include "Util/Math/Aabb.h"
+#include "Util/Math/Vertices.h"
+#include "Bvh.h"
+#include "Engine/Renderer/IRenderer.h"
+#include "Engine/Renderer/RenderThread.h"
+#include "Engine/Memory/FrameArena.h"
+
+// index into the slot table plus the generation the slot had when the entity was created,
+// a handle to a removed entity never matches again even after its slot is reused
+struct EntityHandle {
+	uint32_t index{ UINT32_MAX };
+	uint32_t generation{ 0 };
+
+	constexpr bool operator==(const EntityHandle& other) const { return index == other.index && generation == other.generation; }
+	constexpr bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+};
+
+inline constexpr EntityHandle NullEntity{};
+
+class Scene {
+public:
+	Scene() = default;
+
+	void Reserve(size_t count);
+	void Clear();
+
+	// object space bounding box of a mesh, meshes without one get the unit cube
+	void SetMeshBounds(MeshHandle mesh, const Vec3& center, const Vec3& extents);
+	// object space error of every level of detail of a mesh, meshes without them have a single level
+	void SetMeshLods(MeshHandle mesh, const MeshLod* lods, uint32_t lodCount);
+
+	/* entities */
+	EntityHandle Create(MeshHandle mesh, const Vec3& position, const Vec3& rotation, const Vec3& scaling);
+	bool Destroy(EntityHandle entity);
+	bool IsAlive(EntityHandle entity) const;
+	size_t Size() const { return mMeshes.size(); }
+
+	/* components by handle, entity must be alive */
+	const Vec3& Position(EntityHandle entity) const { return mPositions[DenseIndex(entity)]; }
+	const Vec3& Rotation(EntityHandle entity) const { return mRotations[DenseIndex(entity)]; }
+	const Vec3& Scaling(EntityHandle entity) const { return mScalings[DenseIndex(entity)]; }
+	const Mat4& World(EntityHandle entity) const { return mWorlds[DenseIndex(entity)]; }
+	MeshHandle Mesh(EntityHandle entity) const { return mMeshes[DenseIndex(entity)]; }
+
+	void SetPosition(EntityHandle entity, const Vec3& position);
+	void SetRotation(EntityHandle entity, const Vec3& rotation);
+	void SetScaling(EntityHandle entity, const Vec3& scaling);
+	void SetMesh(EntityHandle entity, MeshHandle mesh);
+
+	/* dense pools, index i of every pool belongs to the same entity, order changes on Destroy */
+	const Vec3* Positions() const { return mPositions.data(); }
+	const Vec3* Rotations() const { return mRotations.data(); }
+	const Vec3* Scalings() const { return mScalings.data(); }
+	const Mat4* Worlds() const { return mWorlds.data(); }
+	const MeshHandle* Meshes() const { return mMeshes.data(); }
+	const Aabb* WorldBounds() const { return mWorldBoxes.data(); }
+	const uint8_t* Visibility() const { return mVisible.data(); }
+	const uint8_t* Lods() const { return mLods.data(); }
+	size_t VisibleCount() const { return mVisibleCount; }
+	EntityHandle EntityAt(size_t denseIndex) const { return { mDenseToSlot[denseIndex], mSlots[mDenseToSlot[denseIndex]].generation }; }
+
+	/* passes */
+	// rebuilds world = S * R * T and the world bounding sphere for every entity whose transform changed since the last call
+	void UpdateTransforms();
+	// marks the entities whose bounding sphere touches the frustum and appends their dense indices
+	// to visible, so the passes after it only touch what is on screen
+	void Cull(const Frustum& frustum, FrameVector<uint32_t>& visible);
+	// picks the level of detail of every visible entity from its projected error, viewportHeight in pixels
+	void SelectLods(const Camera& camera, float viewportHeight, const FrameVector<uint32_t>& visible);
+	// records a draw of every visible entity into the frame's command list
+	void Submit(RenderCommandList& list, const FrameVector<uint32_t>& visible) const;
+	// refits the BVH after moves, rebuilds it after adds/removes or once refits loosened it too much
+	void UpdateSpatialIndex();
+
+	/* spatial queries against world bounding boxes, valid after UpdateSpatialIndex */
+	bool RayCast(const Ray& ray, float maxDistance, EntityHandle& entity, float& distance) const;
+	void Overlap(const Aabb& box, std::vector<EntityHandle>& out) const;
+	bool Nearest(const Vec3& point, float maxDistance, EntityHandle& entity, float& distance) const;
+private:
+	// sparse side, one per handle index ever handed out
+	struct Slot {
+		uint32_t dense;      // index into the pools while alive, next free slot otherwise
+		uint32_t generation;
+	};
+
+	std::vector<Slot> mSlots{};
+	uint32_t mFreeSlot{ UINT32_MAX }; // head of the free list threaded through Slot::dense
+
+	/* dense pools */
+	std::vector<Vec3> mPositions{};
+	std::vector<Vec3> mRotations{};
+	std::vector<Vec3> mScalings{};
+	std::vector<Mat4> mWorlds{};
+	std::vector<MeshHandle> mMeshes{};
+	std::vector<uint8_t> mDirty{};
+	std::vector<uint32_t> mDenseToSlot{};
+	size_t mDirtyCount{};
+
+	/* world bounding spheres, split per component so culling loads four entities at once */
+	std::vector<float> mBoundsX{};
+	std::vector<float> mBoundsY{};
+	std::vector<float> mBoundsZ{};
+	std::vector<float> mBoundsRadius{};
+	std::vector<uint8_t> mVisible{};
+	size_t mVisibleCount{};
+	std::vector<uint8_t> mLods{}; // kept while culled, so hysteresis picks up where it left off
+	std::vector<Aabb> mWorldBoxes{};
+
+	struct MeshBounds {
+		Vec3 center;
+		Vec3 extents;
+	};
+	std::vector<MeshBounds> mMeshBounds{};
+
+	struct MeshLods {
+		uint32_t count;
+		float errors[MaxMeshLods];
+	};
+	std::vector<MeshLods> mMeshLods{};
+
+	/* spatial index over mWorldBoxes, primitive i is dense index i */
+	Bvh mBvh{};
+	bool mBvhRebuild{ true }; // dense indices changed
+	bool mBvhRefit{ false };  // only boxes moved
+
+	uint32_t DenseIndex(EntityHandle entity) const { return mSlots[entity.index].dense; }
+	void MarkDirty(uint32_t dense);
+};
\ No newline at end of file
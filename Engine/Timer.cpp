@@ -1,4 +1,9 @@
 #include "Timer.h"
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
 
 Timer::Timer()
 	: mSecondsPerCount{ 0.0 }
@@ -9,9 +14,7 @@ Timer::Timer()
 	, mCurrTime{ 0 }
 	, mStopped{ false }
 {
-	int64_t countsPerSec{};
-	QueryPerformanceFrequency(reinterpret_cast<LARGE_INTEGER*>(&countsPerSec));
-	mSecondsPerCount = 1.0 / static_cast<double>(countsPerSec);
+	mSecondsPerCount = SecondsPerCount();
 }
 
 float Timer::TotalTime() const {
@@ -33,8 +36,7 @@ void Timer::Tick() {
 		return;
 	}
 
-	int64_t currentTick{};
-	QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER*>(&currentTick));
+	const int64_t currentTick = Now();
 	mCurrTime = currentTick;
 
 	mDeltaTime = (mCurrTime - mPrevTime) * mSecondsPerCount;
@@ -47,8 +49,7 @@ void Timer::Tick() {
 }
 
 void Timer::Reset() {
-	int64_t currTick{};
-	QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER*>(&currTick));
+	const int64_t currTick = Now();
 	
 	mBaseTime = currTick;
 	mPrevTime = currTick;
@@ -58,8 +59,7 @@ void Timer::Reset() {
 
 void Timer::Stop() {
 	if (!mStopped) {
-		int64_t currTick{};
-		QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER*>(&currTick));
+		const int64_t currTick = Now();
 
 		mStopTime = currTick;
 		mStopped = true;
@@ -67,8 +67,7 @@ void Timer::Stop() {
 }
 
 void Timer::Start() {
-	int64_t startTick{};
-	QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER*>(&startTick));
+	const int64_t startTick = Now();
 
 	if (mStopped) {
 		mPausedTime += (startTick - mStopTime);
@@ -78,4 +77,26 @@ void Timer::Start() {
 		mStopTime = 0;
 		mStopped = false;
 	}
+}
+
+int64_t Timer::Now() {
+#ifdef _WIN32
+	LARGE_INTEGER count{};
+	QueryPerformanceCounter(&count);
+	return count.QuadPart;
+#else
+	timespec ts{};
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+double Timer::SecondsPerCount() {
+#ifdef _WIN32
+	LARGE_INTEGER frequency{};
+	QueryPerformanceFrequency(&frequency);
+	return 1.0 / static_cast<double>(frequency.QuadPart);
+#else
+	return 1e-9;
+#endif
 }
\ No newline at end of file
@@ -1,4 +1,10 @@
-#include <Windows.h>
+//
+// Timer
+// High resolution game clock, QueryPerformanceCounter on Windows and
+// CLOCK_MONOTONIC everywhere else
+//
+
+#pragma once
 #include <cstdint>
 
 class Timer {
@@ -11,6 +17,10 @@ public:
 	void Start();
 	void Stop();
 	void Tick();
+
+	// raw monotonic clock, in counts of SecondsPerCount()
+	static int64_t Now();
+	static double SecondsPerCount();
 private:
 	double mSecondsPerCount{};
 	double mDeltaTime{};
@@ -1,23 +1,154 @@
 
-#include <Windows.h>
 #include "Engine/Engine.h"
 #include "Util/Log.h"
-#include "Util/Helper.h"
+#include "Engine/Assets/ObjConverter.h"
+#include "Engine/Renderer/ShaderCache.h"
+#include "Engine/Jobs/JobBenchmark.h"
+#include "Engine/Scene/BvhBenchmark.h"
 
 #include <iostream>
+#include <cstdlib>
+#include <iterator>
+#include <string>
+#include <vector>
 
-int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine, int nCmdShow)
-{
-    IEngine* engine{ new Engine() };
-    if (!engine->Initialize()) {
-        std::cin.get();
-        return 1;
+#ifdef _WIN32
+#include <Windows.h>
+#include <shellapi.h>
+#include "Util/Helper.h"
+#endif
+
+namespace {
+    // -headless          no window and no presentation, runs a fixed number of frames
+    // -frames <count>    frames to run headless
+    // -dt <seconds>      simulated time step of a headless frame
+    // -software / -null  renderer backend
+    // -fps <limit>       frame rate cap while vSync is off
+    // -norenderthread    draws on the main thread, right after the frame is recorded
+    // -objects <count>   extra cubes in the scene
+    // -trace <frames>    profiler capture of the first frames, written to trace.json
+    // -nohotreload       does not watch assets/ for changed shaders and meshes
+    // -convert <in.obj> <out.bmesh> [-noquantize] [-nolod]  converts and optimizes a mesh offline and exits
+    // -compile-shaders   fills the shader cache and exits
+    // -bench-jobs [threads]  times job spawn and steal and ParallelFor scaling up to threads, then exits
+    // -bench-bvh [count]     times BVH build, refit, ray casts and overlaps against brute force, then exits
+    RendererOptions ParseCommandLine(const std::vector<std::string>& args) {
+        RendererOptions options{};
+        for (size_t i = 0; i < args.size(); ++i) {
+            const std::string& arg = args[i];
+            const bool hasValue = i + 1 < args.size();
+
+            if (arg == "-headless") {
+                options.headless = true;
+            }
+            else if (arg == "-software") {
+                options.backend = RendererBackend::Software;
+            }
+            else if (arg == "-null") {
+                options.backend = RendererBackend::Null;
+            }
+            else if (arg == "-norenderthread") {
+                options.renderThread = false;
+            }
+            else if (arg == "-fps" && hasValue) {
+                options.fpsLimit = std::strtof(args[++i].c_str(), nullptr);
+            }
+            else if (arg == "-frames" && hasValue) {
+                options.headlessFrames = static_cast<uint32_t>(std::strtoul(args[++i].c_str(), nullptr, 10));
+            }
+            else if (arg == "-dt" && hasValue) {
+                options.headlessDeltaTime = std::strtof(args[++i].c_str(), nullptr);
+            }
+            else if (arg == "-objects" && hasValue) {
+                options.stressObjects = static_cast<uint32_t>(std::strtoul(args[++i].c_str(), nullptr, 10));
+            }
+            else if (arg == "-trace" && hasValue) {
+                options.traceFrames = static_cast<uint32_t>(std::strtoul(args[++i].c_str(), nullptr, 10));
+            }
+            else if (arg == "-nohotreload") {
+                options.hotReload = false;
+            }
+        }
+        return options;
     }
 
-    engine->Run();
+    int RunEngine(const RendererOptions& options) {
+        IEngine* engine{ new Engine(options) };
+        if (!engine->Initialize()) {
+            if (!options.headless) {
+                std::cin.get();
+            }
+            delete engine;
+            return 1;
+        }
 
+        engine->Run();
 
-    engine->Shutdown();
-    delete engine;
-    return 0;
-}
\ No newline at end of file
+
+        engine->Shutdown();
+        delete engine;
+        return 0;
+    }
+
+    int Run(const std::vector<std::string>& args) {
+        if (args.size() >= 3 && args[0] == "-convert") {
+            Logger::Init();
+            MeshOptimizeOptions options{};
+            for (size_t i = 3; i < args.size(); ++i) {
+                if (args[i] == "-noquantize") {
+                    options.quantize = false;
+                }
+                else if (args[i] == "-nolod") {
+                    options.maxLods = 1;
+                }
+            }
+            const bool converted = ConvertObjToMesh(args[1], args[2], options);
+            Logger::Shutdown();
+            return converted ? 0 : 1;
+        }
+        if (!args.empty() && args[0] == "-compile-shaders") {
+            Logger::Init();
+            ShaderCache cache{};
+            const bool compiled = cache.Build(EngineShaders::All, std::size(EngineShaders::All));
+            Logger::Shutdown();
+            return compiled ? 0 : 1;
+        }
+        if (!args.empty() && args[0] == "-bench-jobs") {
+            Logger::Init();
+            const uint32_t threads = args.size() >= 2 ? static_cast<uint32_t>(std::strtoul(args[1].c_str(), nullptr, 10)) : 0;
+            const bool ran = RunJobBenchmark(threads);
+            Logger::Shutdown();
+            return ran ? 0 : 1;
+        }
+        if (!args.empty() && args[0] == "-bench-bvh") {
+            Logger::Init();
+            const uint32_t count = args.size() >= 2 ? static_cast<uint32_t>(std::strtoul(args[1].c_str(), nullptr, 10)) : 0;
+            const bool ran = RunBvhBenchmark(count);
+            Logger::Shutdown();
+            return ran ? 0 : 1;
+        }
+        return RunEngine(ParseCommandLine(args));
+    }
+}
+
+#ifdef _WIN32
+int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine, int nCmdShow)
+{
+    int argc{};
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+
+    std::vector<std::string> args{};
+    for (int i = 1; i < argc; ++i) {
+        std::wstring arg{ argv[i] };
+        args.emplace_back(arg.begin(), arg.end());
+    }
+    LocalFree(argv);
+
+    return Run(args);
+}
+#else
+int main(int argc, char** argv)
+{
+    return Run({ argv + 1, argv + argc });
+}
+#endif
\ No newline at end of file
@@ -1,23 +1,45 @@
 #include "Log.h"
-#include <iostream>
-#include <iomanip>
-#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
+#include <new>
 
-#define CONSOLE_DEFAULT_COLOR 15
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
 
-HANDLE Logger::hStdout{};
-bool Logger::logToConsole{};
-bool Logger::logToFile{};
-std::ofstream Logger::logFile{};
-bool Logger::logDate{ false };
-bool Logger::logTime{ true };
+namespace {
+#ifdef _WIN32
+	constexpr WORD ConsoleDefaultColor = 15;
+	constexpr WORD ConsoleColors[] = { 3, 14, 12 };
+#else
+	constexpr const char* ConsoleDefaultColor = "\x1b[0m";
+	constexpr const char* ConsoleColors[] = { "\x1b[36m", "\x1b[33m", "\x1b[31m" };
+#endif
+
+	// how long the writer sleeps when a wakeup was missed
+	constexpr std::chrono::milliseconds WriterIdleWait{ 10 };
+}
+
+Logger::Logger()
+	: records{ new Record[Capacity] }
+{
+	for (uint32_t i = 0; i < Capacity; ++i) {
+		records[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
 
 Logger::~Logger()
 {
+	Stop();
 	if (logFile.is_open()) {
 		logFile.close();
 	}
+	delete[] records;
 }
 
 Logger& Logger::Get() {
@@ -26,61 +48,233 @@ Logger& Logger::Get() {
 }
 
 void Logger::Init(bool LogToConsole/*  = true  */, bool LogToFile/*  = false  */, const std::string& filepath/*  = LogFile  */) {
-	
-	Logger::logToConsole = LogToConsole;
-	Logger::logToFile = LogToFile;
+	Get().Start(LogToConsole, LogToFile, filepath);
+}
 
+void Logger::Shutdown() {
+	Get().Stop();
+}
+
+void Logger::Start(bool toConsole, bool toFile, const std::string& filepath) {
+	Stop();
+
+	logToConsole = toConsole;
+	logToFile = toFile;
+
+#ifdef _WIN32
 	if (logToConsole) {
 		hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
 		if (hStdout == INVALID_HANDLE_VALUE) {
 			MessageBox(NULL, TEXT("Invalid StdOut handle, no console logging"), TEXT("Logger::Init"), NULL);
-			Logger::logToConsole = false;
+			logToConsole = false;
 		}
 	}
-	if (LogToFile) {
+#else
+	consoleColors = isatty(fileno(stdout)) != 0;
+#endif
+	if (logToFile) {
 		logFile.open(filepath);
+		if (!logFile.is_open()) {
+			logToFile = false;
+		}
 	}
-}
 
-void Logger::baselog(const std::string& msg, int color) {
-	if (logTime) { std::cout << TimeStamp() << " "; }
-	SetConsoleTextAttribute(hStdout, color);
-	std::cout << msg << std::endl;
-	SetConsoleTextAttribute(hStdout, CONSOLE_DEFAULT_COLOR);
+	writerQuit = false;
+	writer = std::thread(&Logger::WriterLoop, this);
+	running.store(true, std::memory_order_release);
+}
 
-	if (!logToFile) return;
+void Logger::Stop() {
+	if (!writer.joinable()) {
+		return;
+	}
+	running.store(false, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> lock(writerMutex);
+		writerQuit = true;
+	}
+	writerWake.notify_one();
+	writer.join();
 
+	// anything pushed while the writer was exiting
+	WriteQueued();
+	flushed.notify_all();
+}
 
+/* producers */
+void Logger::info(std::string_view msg) {
+	Push(Level::Info, msg);
+}
+void Logger::warning(std::string_view msg) {
+	Push(Level::Warning, msg);
+}
+void Logger::error(std::string_view msg) {
+	Push(Level::Error, msg);
 }
 
-void Logger::info(std::string msg) {
-	baselog(msg, 3);
+void Logger::Push(Level level, std::string_view msg) {
+	const int64_t time = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+
+	if (!running.load(std::memory_order_acquire)) {
+		// before Init or after Shutdown there is no writer, write on the calling thread
+		std::lock_guard<std::mutex> lock(writerMutex);
+		Write(level, time, msg);
+		return;
+	}
+
+	// claim a record, bounded MPSC queue with a sequence number per record
+	uint64_t position = writePosition.load(std::memory_order_relaxed);
+	Record* record{ nullptr };
+	for (;;) {
+		record = &records[position & (Capacity - 1)];
+		const uint64_t sequence = record->sequence.load(std::memory_order_acquire);
+		const int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+		if (diff == 0) {
+			if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if (diff < 0) {
+			// full, the writer has not caught up: drop info spam, but never lose warnings or errors
+			if (level == Level::Info) {
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			writerWake.notify_one();
+			std::this_thread::yield();
+			position = writePosition.load(std::memory_order_relaxed);
+		}
+		else {
+			position = writePosition.load(std::memory_order_relaxed);
+		}
+	}
 
+	const size_t length = std::min<size_t>(msg.size(), TextSize);
+	std::memcpy(record->text, msg.data(), length);
+	record->time = time;
+	record->level = static_cast<uint16_t>(level);
+	record->length = static_cast<uint16_t>(length);
+	record->sequence.store(position + 1, std::memory_order_seq_cst);
+
+	if (writerSleeping.load(std::memory_order_seq_cst)) {
+		writerWake.notify_one();
+	}
 }
-void Logger::warning(std::string msg) {
-	baselog(msg, 14);
+
+void Logger::Flush() {
+	if (!running.load(std::memory_order_acquire)) {
+		return;
+	}
+	const uint64_t target = writePosition.load(std::memory_order_acquire);
+	std::unique_lock<std::mutex> lock(writerMutex);
+	writerWake.notify_one();
+	flushed.wait(lock, [&] { return writtenPosition.load(std::memory_order_acquire) >= target || !running.load(std::memory_order_acquire); });
 }
-void Logger::error(std::string msg) {
-	baselog(msg, 12);
+
+/* writer thread */
+void Logger::WriterLoop() {
+	for (;;) {
+		const bool wroteAny = WriteQueued();
+
+		std::unique_lock<std::mutex> lock(writerMutex);
+		if (wroteAny) {
+			flushed.notify_all();
+			continue;
+		}
+		if (writerQuit) {
+			return;
+		}
+
+		// Push reads writerSleeping after publishing, so either it sees the flag or the recheck sees the record
+		writerSleeping.store(true, std::memory_order_seq_cst);
+		const Record& next = records[readPosition & (Capacity - 1)];
+		if (next.sequence.load(std::memory_order_seq_cst) != readPosition + 1) {
+			writerWake.wait_for(lock, WriterIdleWait);
+		}
+		writerSleeping.store(false, std::memory_order_relaxed);
+	}
 }
 
+bool Logger::WriteQueued() {
+	bool wroteAny{ false };
+	for (;;) {
+		Record& record = records[readPosition & (Capacity - 1)];
+		if (record.sequence.load(std::memory_order_acquire) != readPosition + 1) {
+			break;
+		}
 
-std::string Logger::TimeStamp() {
-	std::time_t time{ std::time(NULL) };
-	std::tm now{};
-	localtime_s(&now, &time);
+		Write(static_cast<Level>(record.level), record.time, { record.text, record.length });
+		// hand the record back to producers one lap later
+		record.sequence.store(readPosition + Capacity, std::memory_order_release);
+		++readPosition;
+		wroteAny = true;
+	}
+
+	const uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+	if (lost > 0) {
+		const std::string msg = std::to_string(lost) + " log messages dropped, the queue was full";
+		Write(Level::Warning, std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count(), msg);
+		wroteAny = true;
+	}
+
+	if (wroteAny) {
+		if (logToConsole) {
+			std::fflush(stdout);
+		}
+		if (logToFile) {
+			logFile.flush();
+		}
+		writtenPosition.store(readPosition, std::memory_order_release);
+	}
+	return wroteAny;
+}
+
+void Logger::Write(Level level, int64_t time, std::string_view msg) {
+	char stamp[32]{};
+	TimeStamp(time, stamp, sizeof(stamp));
+	const int color = static_cast<int>(level);
+
+	if (logToConsole) {
+#ifdef _WIN32
+		std::fputs(stamp, stdout);
+		std::fflush(stdout);
+		SetConsoleTextAttribute(hStdout, ConsoleColors[color]);
+		std::fwrite(msg.data(), 1, msg.size(), stdout);
+		std::fputc('\n', stdout);
+		std::fflush(stdout);
+		SetConsoleTextAttribute(hStdout, ConsoleDefaultColor);
+#else
+		if (consoleColors) {
+			std::fprintf(stdout, "%s%s%.*s%s\n", stamp, ConsoleColors[color], static_cast<int>(msg.size()), msg.data(), ConsoleDefaultColor);
+		}
+		else {
+			std::fprintf(stdout, "%s%.*s\n", stamp, static_cast<int>(msg.size()), msg.data());
+		}
+#endif
+	}
 
-	std::ostringstream oss;
+	if (logToFile) {
+		constexpr const char* levelNames[] = { "INFO", "WARNING", "ERROR" };
+		logFile << stamp << levelNames[color] << ": " << msg << '\n';
+	}
+}
 
-	if (logTime) {
-		oss << "["
-			<< std::setfill('0') << std::setw(2) << now.tm_hour
-			<< ":"
-			<< std::setfill('0') << std::setw(2) << now.tm_min
-			<< ":"
-			<< std::setfill('0') << std::setw(2) << now.tm_sec
-			<< "]";
+void Logger::TimeStamp(int64_t time, char* out, size_t size) const {
+	out[0] = '\0';
+	if (!logDate && !logTime) {
+		return;
 	}
 
-	return oss.str();
+	const std::time_t seconds = static_cast<std::time_t>(time / 1000000);
+	std::tm now{};
+#ifdef _WIN32
+	localtime_s(&now, &seconds);
+#else
+	localtime_r(&seconds, &now);
+#endif
+
+	const char* format = logDate && logTime ? "%Y-%m-%d [%H:%M:%S] " : logDate ? "%Y-%m-%d " : "[%H:%M:%S] ";
+	std::strftime(out, size, format, &now);
 }
\ No newline at end of file
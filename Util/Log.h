@@ -1,30 +1,88 @@
+//
+// Logger
+// Callers only copy the message into a lock-free ring buffer, a background
+// thread formats the timestamp and writes to the console and log file
+// Messages longer than a record are truncated, when the ring is full info
+// messages are dropped and counted instead of stalling the caller
+//
+
 #pragma once
-#include <Windows.h>
-#include <string>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
 
 class Logger {
 public:
 	static Logger& Get();
 
 	static void Init(bool LogToConsole = true, bool LogToFile = false, const std::string& filepath = "LogFile");
-	
-	void info(std::string msg);
-	void warning(std::string msg);
-	void error(std::string msg);
+	// writes everything still queued and stops the writer thread, logging after this is synchronous
+	static void Shutdown();
+
+	void info(std::string_view msg);
+	void warning(std::string_view msg);
+	void error(std::string_view msg);
+
+	// blocks until every message logged so far has been written
+	void Flush();
 private:
-	static HANDLE hStdout;
-	static bool logToConsole;
-	static bool logToFile;
-	static std::ofstream logFile;
-	static bool logDate;
-	static bool logTime;
-
-	Logger() = default;
+	enum class Level : uint8_t { Info, Warning, Error };
+
+	static constexpr uint32_t RecordSize = 256;
+	static constexpr uint32_t TextSize = RecordSize - sizeof(uint64_t) - sizeof(int64_t) - 2 * sizeof(uint16_t);
+	static constexpr uint32_t Capacity = 4096; // records, power of two
+
+	// sequence == position: free for the producer claiming position
+	// sequence == position + 1: written, ready for the writer
+	struct alignas(64) Record {
+		std::atomic<uint64_t> sequence;
+		int64_t time; // system clock, microseconds since epoch
+		uint16_t level;
+		uint16_t length;
+		char text[TextSize];
+	};
+	static_assert(sizeof(Record) == RecordSize, "log records should stay one size");
+
+	Record* records{ nullptr };
+	alignas(64) std::atomic<uint64_t> writePosition{ 0 }; // next position a producer claims
+	alignas(64) uint64_t readPosition{ 0 };               // writer thread only
+	std::atomic<uint64_t> writtenPosition{ 0 };           // everything before this reached the outputs
+	std::atomic<uint64_t> dropped{ 0 };
+
+	std::thread writer{};
+	std::atomic<bool> running{ false };
+	std::mutex writerMutex{};
+	std::condition_variable writerWake{};
+	std::condition_variable flushed{};
+	std::atomic<bool> writerSleeping{ false };
+	bool writerQuit{ false };
+
+	bool logToConsole{ true };
+	bool logToFile{ false };
+	std::ofstream logFile{};
+	bool logDate{ false };
+	bool logTime{ true };
+#ifdef _WIN32
+	void* hStdout{ nullptr };
+#else
+	bool consoleColors{ false }; // only when stdout is a terminal, pipes and redirects get plain text
+#endif
+
+	Logger();
 	~Logger();
 
-	void baselog(const std::string& msg, int color);
-	std::string TimeStamp();
+	void Start(bool toConsole, bool toFile, const std::string& filepath);
+	void Stop();
+	void Push(Level level, std::string_view msg);
+	void WriterLoop();
+	bool WriteQueued();
+	void Write(Level level, int64_t time, std::string_view msg);
+	void TimeStamp(int64_t time, char* out, size_t size) const;
 
 	Logger(const Logger&) = delete;
 	Logger& operator=(const Logger&) = delete;
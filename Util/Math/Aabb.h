@@ -0,0 +1,81 @@
+#pragma once
+#include <cfloat>
+#include <cmath>
+#include "Vectors.h"
+#include "Mat4.h"
+
+// Axis aligned box, an empty box has min > max so growing it by anything gives that thing
+struct Aabb {
+	Vec3 min{ FLT_MAX, FLT_MAX, FLT_MAX };
+	Vec3 max{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+	static constexpr Aabb FromCenterExtents(const Vec3& center, const Vec3& extents) {
+		return { center - extents, center + extents };
+	}
+
+	constexpr bool Empty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+	constexpr Vec3 Center() const { return (min + max) * 0.5f; }
+	constexpr Vec3 Extents() const { return (max - min) * 0.5f; }
+
+	constexpr void Grow(const Vec3& p) { min = Min(min, p); max = Max(max, p); }
+	constexpr void Grow(const Aabb& b) { min = Min(min, b.min); max = Max(max, b.max); }
+
+	// half the surface area, only ever compared so the factor of two is dropped
+	constexpr float HalfArea() const {
+		if (Empty()) {
+			return 0.0f;
+		}
+		const Vec3 d = max - min;
+		return d.x * d.y + d.y * d.z + d.z * d.x;
+	}
+
+	constexpr bool Overlaps(const Aabb& b) const {
+		return min.x <= b.max.x && max.x >= b.min.x
+			&& min.y <= b.max.y && max.y >= b.min.y
+			&& min.z <= b.max.z && max.z >= b.min.z;
+	}
+
+	// squared distance from p to the closest point of the box, zero inside
+	constexpr float DistanceSquared(const Vec3& p) const {
+		const Vec3 d = Max(Max(min - p, p - max), Vec3{ 0.0f });
+		return Dot(d, d);
+	}
+};
+
+constexpr Aabb Union(const Aabb& a, const Aabb& b) { return { Min(a.min, b.min), Max(a.max, b.max) }; }
+
+// box of a transformed box, each output axis collects |M| times the extents (Arvo)
+inline Aabb TransformAabb(const Vec3& center, const Vec3& extents, const Mat4& m) {
+	const Vec4 c = TransformPoint(center, m);
+	Vec3 e{};
+	for (int axis = 0; axis < 3; ++axis) {
+		(&e.x)[axis] = std::abs(m.m[0][axis]) * extents.x + std::abs(m.m[1][axis]) * extents.y + std::abs(m.m[2][axis]) * extents.z;
+	}
+	return Aabb::FromCenterExtents(c.xyz(), e);
+}
+
+struct Ray {
+	Vec3 origin{};
+	Vec3 direction{ 0.0f, 0.0f, 1.0f };
+};
+
+// precomputed reciprocal direction for repeated slab tests against many boxes
+struct RayInv {
+	Vec3 origin{};
+	Vec3 invDirection{};
+
+	explicit RayInv(const Ray& ray)
+		: origin{ ray.origin },
+		invDirection{ 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z } {}
+};
+
+// slab test, entry distance along the ray or a negative value on a miss
+inline float Intersect(const RayInv& ray, const Aabb& box, float maxDistance) {
+	const Vec3 t0 = (box.min - ray.origin) * ray.invDirection;
+	const Vec3 t1 = (box.max - ray.origin) * ray.invDirection;
+	const Vec3 tNear = Min(t0, t1);
+	const Vec3 tFar = Max(t0, t1);
+	const float enter = std::fmax(std::fmax(tNear.x, tNear.y), std::fmax(tNear.z, 0.0f));
+	const float exit = std::fmin(std::fmin(tFar.x, tFar.y), std::fmin(tFar.z, maxDistance));
+	return enter <= exit ? enter : -1.0f;
+}
\ No newline at end of file
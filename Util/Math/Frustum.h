@@ -0,0 +1,87 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "Simd.h"
+#include "Vectors.h"
+#include "Mat4.h"
+
+// Six inward facing planes (a, b, c, d) with a * x + b * y + c * z + d >= 0 inside,
+// normalized so the plane value is a signed distance
+struct Frustum {
+	enum Side { Left, Right, Bottom, Top, Near, Far, Count };
+	Vec4 planes[Count];
+
+	// planes of a view-projection with row vectors and depth in [0, 1] (Gribb/Hartmann),
+	// a world matrix in front gives object space planes
+	static Frustum FromViewProj(const Mat4& m) {
+		auto column = [&](int c) { return Vec4{ m.m[0][c], m.m[1][c], m.m[2][c], m.m[3][c] }; };
+		const Vec4 c0 = column(0), c1 = column(1), c2 = column(2), c3 = column(3);
+
+		Frustum f{};
+		f.planes[Left] = c3 + c0;
+		f.planes[Right] = c3 - c0;
+		f.planes[Bottom] = c3 + c1;
+		f.planes[Top] = c3 - c1;
+		f.planes[Near] = c2;
+		f.planes[Far] = c3 - c2;
+		for (Vec4& p : f.planes) {
+			const float length = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+			if (length > 0.0f) {
+				p = p * (1.0f / length);
+			}
+		}
+		return f;
+	}
+
+	bool IntersectsSphere(const Vec3& center, float radius) const {
+		for (const Vec4& p : planes) {
+			if (p.x * center.x + p.y * center.y + p.z * center.z + p.w < -radius) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+// Tests four spheres at once, one SIMD lane per sphere, x/y/z/radius are structure-of-arrays.
+// visible[i] is set to 1 when sphere i touches the frustum and 0 otherwise
+inline void CullSpheres(const Frustum& frustum, const float* x, const float* y, const float* z, const float* radius,
+	size_t count, uint8_t* visible) {
+	simd::float4 planeA[Frustum::Count], planeB[Frustum::Count], planeC[Frustum::Count], planeD[Frustum::Count];
+	for (int p = 0; p < Frustum::Count; ++p) {
+		planeA[p] = simd::Splat(frustum.planes[p].x);
+		planeB[p] = simd::Splat(frustum.planes[p].y);
+		planeC[p] = simd::Splat(frustum.planes[p].z);
+		planeD[p] = simd::Splat(frustum.planes[p].w);
+	}
+
+	auto test = [&](simd::float4 cx, simd::float4 cy, simd::float4 cz, simd::float4 r, uint8_t* out, size_t lanes) {
+		// smallest signed distance plus radius over all planes, negative means outside one of them
+		simd::float4 nearest = simd::Add(simd::MulAdd(planeA[0], cx, simd::MulAdd(planeB[0], cy, simd::MulAdd(planeC[0], cz, planeD[0]))), r);
+		for (int p = 1; p < Frustum::Count; ++p) {
+			const simd::float4 d = simd::MulAdd(planeA[p], cx, simd::MulAdd(planeB[p], cy, simd::MulAdd(planeC[p], cz, planeD[p])));
+			nearest = simd::Min(nearest, simd::Add(d, r));
+		}
+		float result[4];
+		simd::Store(result, nearest);
+		for (size_t lane = 0; lane < lanes; ++lane) {
+			out[lane] = result[lane] >= 0.0f ? 1 : 0;
+		}
+	};
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		test(simd::Load(x + i), simd::Load(y + i), simd::Load(z + i), simd::Load(radius + i), visible + i, 4);
+	}
+	if (i < count) {
+		float tail[4][4]{};
+		for (size_t lane = 0; i + lane < count; ++lane) {
+			tail[0][lane] = x[i + lane];
+			tail[1][lane] = y[i + lane];
+			tail[2][lane] = z[i + lane];
+			tail[3][lane] = radius[i + lane];
+		}
+		test(simd::Load(tail[0]), simd::Load(tail[1]), simd::Load(tail[2]), simd::Load(tail[3]), visible + i, count - i);
+	}
+}
\ No newline at end of file
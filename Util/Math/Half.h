@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+// IEEE 754 binary16, as read by DXGI_FORMAT_R16*_FLOAT
+// Rounds to nearest even, values past the largest half (HalfMax) become infinity
+
+constexpr float HalfMax = 65504.0f;
+
+inline uint16_t FloatToHalf(float value) {
+	uint32_t bits{};
+	std::memcpy(&bits, &value, sizeof(bits));
+	const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+	bits &= 0x7FFFFFFF;
+
+	if (bits >= 0x7F800000) {
+		// infinity stays infinity, NaN stays a (quiet) NaN
+		return sign | 0x7C00 | (bits > 0x7F800000 ? 0x200 : 0);
+	}
+	if (bits >= 0x477FF000) {
+		return sign | 0x7C00;
+	}
+	if (bits < 0x38800000) {
+		// subnormal half, value = m * 2^-24
+		if (bits < 0x33000000) {
+			return sign;
+		}
+		const uint32_t exponent = bits >> 23;
+		const uint32_t mantissa = (bits & 0x7FFFFF) | 0x800000;
+		const uint32_t shift = 126 - exponent;
+		uint32_t half = mantissa >> shift;
+		const uint32_t rest = mantissa & ((1u << shift) - 1);
+		const uint32_t halfway = 1u << (shift - 1);
+		if (rest > halfway || (rest == halfway && (half & 1))) {
+			++half;
+		}
+		return sign | static_cast<uint16_t>(half);
+	}
+
+	// rebias the exponent from 127 to 15, a carry out of the mantissa correctly bumps the exponent
+	uint32_t half = (bits - 0x38000000) >> 13;
+	const uint32_t rest = bits & 0x1FFF;
+	if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+		++half;
+	}
+	return sign | static_cast<uint16_t>(half);
+}
+
+inline float HalfToFloat(uint16_t half) {
+	const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+	const uint32_t exponent = (half >> 10) & 0x1F;
+	const uint32_t mantissa = half & 0x3FF;
+
+	uint32_t bits{};
+	if (exponent == 0) {
+		const float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+		std::memcpy(&bits, &magnitude, sizeof(bits));
+		bits |= sign;
+	}
+	else if (exponent == 31) {
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else {
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+
+	float value{};
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
\ No newline at end of file
@@ -1,5 +1,187 @@
 #pragma once
+#include <cmath>
+#include <cstddef>
+#include "Simd.h"
+#include "Vectors.h"
 
-struct Mat4 {
+// Row-major, row vectors (v * M), same conventions as DirectXMath:
+// world = S * R * T and worldViewProj = world * view * proj.
+// Transpose before uploading to HLSL constant buffers.
+struct alignas(16) Mat4 {
 	float m[4][4];
-};
\ No newline at end of file
+
+	constexpr Mat4() : m{} {}
+	constexpr Mat4(
+		float m00, float m01, float m02, float m03,
+		float m10, float m11, float m12, float m13,
+		float m20, float m21, float m22, float m23,
+		float m30, float m31, float m32, float m33)
+		: m{ { m00, m01, m02, m03 }, { m10, m11, m12, m13 }, { m20, m21, m22, m23 }, { m30, m31, m32, m33 } } {}
+
+	simd::float4 Row(int i) const { return simd::Load(m[i]); }
+	void SetRow(int i, simd::float4 v) { simd::Store(m[i], v); }
+
+	static constexpr Mat4 Identity() {
+		return {
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f };
+	}
+
+	static constexpr Mat4 Scaling(float x, float y, float z) {
+		return {
+			x, 0.0f, 0.0f, 0.0f,
+			0.0f, y, 0.0f, 0.0f,
+			0.0f, 0.0f, z, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f };
+	}
+	static constexpr Mat4 Scaling(const Vec3& s) { return Scaling(s.x, s.y, s.z); }
+
+	static constexpr Mat4 Translation(float x, float y, float z) {
+		return {
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			x, y, z, 1.0f };
+	}
+	static constexpr Mat4 Translation(const Vec3& t) { return Translation(t.x, t.y, t.z); }
+
+	// roll (z) first, then pitch (x), then yaw (y), angles in radians
+	static Mat4 RotationRollPitchYaw(float pitch, float yaw, float roll) {
+		const float cp = std::cos(pitch), sp = std::sin(pitch);
+		const float cy = std::cos(yaw), sy = std::sin(yaw);
+		const float cr = std::cos(roll), sr = std::sin(roll);
+		return {
+			cr * cy + sr * sp * sy, sr * cp, sr * sp * cy - cr * sy, 0.0f,
+			cr * sp * sy - sr * cy, cr * cp, sr * sy + cr * sp * cy, 0.0f,
+			cp * sy, -sp, cp * cy, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f };
+	}
+	static Mat4 RotationRollPitchYaw(const Vec3& pitchYawRoll) {
+		return RotationRollPitchYaw(pitchYawRoll.x, pitchYawRoll.y, pitchYawRoll.z);
+	}
+
+	// left handed, depth maps to [0, 1]
+	static Mat4 PerspectiveFovLH(float fovY, float aspectRatio, float nearZ, float farZ) {
+		const float h = 1.0f / std::tan(fovY * 0.5f);
+		const float w = h / aspectRatio;
+		const float range = farZ / (farZ - nearZ);
+		return {
+			w, 0.0f, 0.0f, 0.0f,
+			0.0f, h, 0.0f, 0.0f,
+			0.0f, 0.0f, range, 1.0f,
+			0.0f, 0.0f, -range * nearZ, 0.0f };
+	}
+
+	static Mat4 LookAtLH(const Vec3& eye, const Vec3& target, const Vec3& up) {
+		const Vec3 zAxis = Normalize(target - eye);
+		const Vec3 xAxis = Normalize(Cross(up, zAxis));
+		const Vec3 yAxis = Cross(zAxis, xAxis);
+		return {
+			xAxis.x, yAxis.x, zAxis.x, 0.0f,
+			xAxis.y, yAxis.y, zAxis.y, 0.0f,
+			xAxis.z, yAxis.z, zAxis.z, 0.0f,
+			-Dot(xAxis, eye), -Dot(yAxis, eye), -Dot(zAxis, eye), 1.0f };
+	}
+
+	constexpr Mat4 Transposed() const {
+		return {
+			m[0][0], m[1][0], m[2][0], m[3][0],
+			m[0][1], m[1][1], m[2][1], m[3][1],
+			m[0][2], m[1][2], m[2][2], m[3][2],
+			m[0][3], m[1][3], m[2][3], m[3][3] };
+	}
+};
+
+// v * M, with a 4 component row vector
+inline simd::float4 Transform(simd::float4 v, const Mat4& mat) {
+	simd::float4 r = simd::Mul(simd::SplatX(v), mat.Row(0));
+	r = simd::MulAdd(simd::SplatY(v), mat.Row(1), r);
+	r = simd::MulAdd(simd::SplatZ(v), mat.Row(2), r);
+	return simd::MulAdd(simd::SplatW(v), mat.Row(3), r);
+}
+
+inline Vec4 Transform(const Vec4& v, const Mat4& mat) {
+	return Vec4::From(Transform(v.Load(), mat));
+}
+
+// (p, 1) * M, no divide by w
+inline Vec4 TransformPoint(const Vec3& p, const Mat4& mat) {
+	simd::float4 r = simd::MulAdd(simd::Splat(p.x), mat.Row(0), mat.Row(3));
+	r = simd::MulAdd(simd::Splat(p.y), mat.Row(1), r);
+	return Vec4::From(simd::MulAdd(simd::Splat(p.z), mat.Row(2), r));
+}
+
+inline Mat4 operator*(const Mat4& a, const Mat4& b) {
+	Mat4 r;
+#if defined(BUG_MATH_AVX)
+	// two rows of the result per 256 bit register
+	const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b.m[0]));
+	const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b.m[1]));
+	const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b.m[2]));
+	const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b.m[3]));
+	for (int i = 0; i < 4; i += 2) {
+		const __m256 rows = _mm256_loadu_ps(a.m[i]);
+		__m256 t = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x00), b0);
+		t = _mm256_add_ps(t, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x55), b1));
+		t = _mm256_add_ps(t, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xAA), b2));
+		t = _mm256_add_ps(t, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xFF), b3));
+		_mm256_storeu_ps(r.m[i], t);
+	}
+#else
+	for (int i = 0; i < 4; ++i) {
+		r.SetRow(i, Transform(a.Row(i), b));
+	}
+#endif
+	return r;
+}
+
+/* batch routines */
+
+// out[i] = (points[i], 1) * M
+inline void TransformPoints(const Vec3* points, size_t count, const Mat4& mat, Vec4* out) {
+	const simd::float4 r0 = mat.Row(0);
+	const simd::float4 r1 = mat.Row(1);
+	const simd::float4 r2 = mat.Row(2);
+	const simd::float4 r3 = mat.Row(3);
+	size_t i = 0;
+#if defined(BUG_MATH_AVX)
+	const __m256 w0 = _mm256_set_m128(r0, r0);
+	const __m256 w1 = _mm256_set_m128(r1, r1);
+	const __m256 w2 = _mm256_set_m128(r2, r2);
+	const __m256 w3 = _mm256_set_m128(r3, r3);
+	for (; i + 2 <= count; i += 2) {
+		const Vec3& p = points[i];
+		const Vec3& q = points[i + 1];
+		__m256 t = _mm256_add_ps(_mm256_mul_ps(_mm256_set_m128(_mm_set1_ps(q.x), _mm_set1_ps(p.x)), w0), w3);
+		t = _mm256_add_ps(t, _mm256_mul_ps(_mm256_set_m128(_mm_set1_ps(q.y), _mm_set1_ps(p.y)), w1));
+		t = _mm256_add_ps(t, _mm256_mul_ps(_mm256_set_m128(_mm_set1_ps(q.z), _mm_set1_ps(p.z)), w2));
+		_mm256_storeu_ps(&out[i].x, t);
+	}
+#endif
+	for (; i < count; ++i) {
+		const Vec3& p = points[i];
+		simd::float4 t = simd::MulAdd(simd::Splat(p.x), r0, r3);
+		t = simd::MulAdd(simd::Splat(p.y), r1, t);
+		simd::Store(&out[i].x, simd::MulAdd(simd::Splat(p.z), r2, t));
+	}
+}
+
+// out[i] = matrices[i] * M, e.g. every world matrix by one view-projection
+inline void MultiplyBatch(const Mat4* matrices, size_t count, const Mat4& mat, Mat4* out) {
+	const simd::float4 r0 = mat.Row(0);
+	const simd::float4 r1 = mat.Row(1);
+	const simd::float4 r2 = mat.Row(2);
+	const simd::float4 r3 = mat.Row(3);
+	for (size_t i = 0; i < count; ++i) {
+		const Mat4& a = matrices[i];
+		for (int row = 0; row < 4; ++row) {
+			const simd::float4 v = a.Row(row);
+			simd::float4 t = simd::Mul(simd::SplatX(v), r0);
+			t = simd::MulAdd(simd::SplatY(v), r1, t);
+			t = simd::MulAdd(simd::SplatZ(v), r2, t);
+			out[i].SetRow(row, simd::MulAdd(simd::SplatW(v), r3, t));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+namespace Math {
+	inline constexpr float Pi = 3.14159265358979323846f;
+	inline constexpr float PiDiv2 = Pi / 2.0f;
+	inline constexpr float PiDiv4 = Pi / 4.0f;
+
+	constexpr float ToRadians(float degrees) { return degrees * (Pi / 180.0f); }
+	constexpr float ToDegrees(float radians) { return radians * (180.0f / Pi); }
+}
\ No newline at end of file
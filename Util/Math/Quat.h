@@ -0,0 +1,94 @@
+#pragma once
+#include <cmath>
+#include "Simd.h"
+#include "Vectors.h"
+#include "Mat4.h"
+
+// Unit quaternion (x, y, z) * sin(angle / 2), w = cos(angle / 2)
+struct Quat {
+	float x, y, z, w;
+
+	constexpr Quat() : x{ 0.0f }, y{ 0.0f }, z{ 0.0f }, w{ 1.0f } {}
+	constexpr Quat(float x, float y, float z, float w) : x{ x }, y{ y }, z{ z }, w{ w } {}
+
+	simd::float4 Load() const { return simd::Load(&x); }
+	static Quat From(simd::float4 v) { Quat q{}; simd::Store(&q.x, v); return q; }
+
+	static constexpr Quat Identity() { return {}; }
+
+	static Quat AxisAngle(const Vec3& axis, float angle) {
+		const Vec3 n = Normalize(axis);
+		const float s = std::sin(angle * 0.5f);
+		return { n.x * s, n.y * s, n.z * s, std::cos(angle * 0.5f) };
+	}
+
+	// same rotation order as Mat4::RotationRollPitchYaw
+	static Quat RollPitchYaw(float pitch, float yaw, float roll) {
+		const float cp = std::cos(pitch * 0.5f), sp = std::sin(pitch * 0.5f);
+		const float cy = std::cos(yaw * 0.5f), sy = std::sin(yaw * 0.5f);
+		const float cr = std::cos(roll * 0.5f), sr = std::sin(roll * 0.5f);
+		return {
+			cr * sp * cy + sr * cp * sy,
+			cr * cp * sy - sr * sp * cy,
+			sr * cp * cy - cr * sp * sy,
+			cr * cp * cy + sr * sp * sy };
+	}
+
+	constexpr Quat Conjugate() const { return { -x, -y, -z, w }; }
+
+	Mat4 ToMat4() const {
+		const float xx = x * x, yy = y * y, zz = z * z;
+		const float xy = x * y, xz = x * z, yz = y * z;
+		const float wx = w * x, wy = w * y, wz = w * z;
+		return {
+			1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f,
+			2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f,
+			2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f };
+	}
+};
+
+// Hamilton product, rotating by (a * b) applies b first, then a
+inline Quat operator*(const Quat& a, const Quat& b) {
+	const simd::float4 qb = b.Load();
+	simd::float4 r = simd::Mul(simd::Splat(a.w), qb);
+	r = simd::MulAdd(simd::Mul(simd::Splat(a.x), simd::Set(1.0f, -1.0f, 1.0f, -1.0f)), simd::Shuffle<3, 2, 1, 0>(qb), r);
+	r = simd::MulAdd(simd::Mul(simd::Splat(a.y), simd::Set(1.0f, 1.0f, -1.0f, -1.0f)), simd::Shuffle<2, 3, 0, 1>(qb), r);
+	r = simd::MulAdd(simd::Mul(simd::Splat(a.z), simd::Set(-1.0f, 1.0f, 1.0f, -1.0f)), simd::Shuffle<1, 0, 3, 2>(qb), r);
+	return Quat::From(r);
+}
+
+inline float Dot(const Quat& a, const Quat& b) {
+	return simd::GetX(simd::HorizontalSum(simd::Mul(a.Load(), b.Load())));
+}
+
+inline Quat Normalize(const Quat& q) {
+	const float len = std::sqrt(Dot(q, q));
+	return len > 0.0f ? Quat::From(simd::Mul(q.Load(), simd::Splat(1.0f / len))) : q;
+}
+
+inline Vec3 Rotate(const Quat& q, const Vec3& v) {
+	const Vec3 u{ q.x, q.y, q.z };
+	const Vec3 t = 2.0f * Cross(u, v);
+	return v + q.w * t + Cross(u, t);
+}
+
+// shortest path spherical interpolation, falls back to nlerp when nearly parallel
+inline Quat Slerp(const Quat& a, const Quat& b, float t) {
+	float cosTheta = Dot(a, b);
+	simd::float4 qb = b.Load();
+	if (cosTheta < 0.0f) {
+		cosTheta = -cosTheta;
+		qb = simd::Sub(simd::Zero(), qb);
+	}
+
+	float wa = 1.0f - t;
+	float wb = t;
+	if (cosTheta < 0.9995f) {
+		const float theta = std::acos(cosTheta);
+		const float invSin = 1.0f / std::sin(theta);
+		wa = std::sin(wa * theta) * invSin;
+		wb = std::sin(wb * theta) * invSin;
+	}
+	return Normalize(Quat::From(simd::MulAdd(simd::Splat(wa), a.Load(), simd::Mul(simd::Splat(wb), qb))));
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+//
+// SIMD backend for the math library
+// Picks AVX/SSE on x86, NEON on ARM64 and a scalar fallback everywhere else
+// Define BUG_MATH_FORCE_SCALAR to compile the fallback on any target
+//
+
+#pragma once
+
+#if !defined(BUG_MATH_FORCE_SCALAR) && (defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__))
+#define BUG_MATH_SSE
+#include <immintrin.h>
+#if defined(__AVX__)
+#define BUG_MATH_AVX
+#endif
+#if defined(__FMA__) || defined(__AVX2__)
+#define BUG_MATH_FMA
+#endif
+#elif !defined(BUG_MATH_FORCE_SCALAR) && ((defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64))
+#define BUG_MATH_NEON
+#include <arm_neon.h>
+#else
+#define BUG_MATH_SCALAR
+#endif
+
+namespace simd {
+
+#if defined(BUG_MATH_SSE)
+	using float4 = __m128;
+
+	inline float4 Load(const float* p) { return _mm_loadu_ps(p); }
+	inline void Store(float* p, float4 v) { _mm_storeu_ps(p, v); }
+	inline float4 Set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+	inline float4 Splat(float s) { return _mm_set1_ps(s); }
+	inline float4 Zero() { return _mm_setzero_ps(); }
+
+	inline float4 Add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+	inline float4 Sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+	inline float4 Mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+	inline float4 Div(float4 a, float4 b) { return _mm_div_ps(a, b); }
+	inline float4 Min(float4 a, float4 b) { return _mm_min_ps(a, b); }
+	inline float4 Max(float4 a, float4 b) { return _mm_max_ps(a, b); }
+
+	// a * b + c
+	inline float4 MulAdd(float4 a, float4 b, float4 c) {
+#if defined(BUG_MATH_FMA)
+		return _mm_fmadd_ps(a, b, c);
+#else
+		return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+	}
+
+	// result lane i = v[lane index i]
+	template <int X, int Y, int Z, int W>
+	inline float4 Shuffle(float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X)); }
+
+	inline float GetX(float4 v) { return _mm_cvtss_f32(v); }
+
+#elif defined(BUG_MATH_NEON)
+	using float4 = float32x4_t;
+
+	inline float4 Load(const float* p) { return vld1q_f32(p); }
+	inline void Store(float* p, float4 v) { vst1q_f32(p, v); }
+	inline float4 Set(float x, float y, float z, float w) { const float v[4] = { x, y, z, w }; return vld1q_f32(v); }
+	inline float4 Splat(float s) { return vdupq_n_f32(s); }
+	inline float4 Zero() { return vdupq_n_f32(0.0f); }
+
+	inline float4 Add(float4 a, float4 b) { return vaddq_f32(a, b); }
+	inline float4 Sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+	inline float4 Mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+	inline float4 Div(float4 a, float4 b) { return vdivq_f32(a, b); }
+	inline float4 Min(float4 a, float4 b) { return vminq_f32(a, b); }
+	inline float4 Max(float4 a, float4 b) { return vmaxq_f32(a, b); }
+	inline float4 MulAdd(float4 a, float4 b, float4 c) { return vfmaq_f32(c, a, b); }
+
+	template <int X, int Y, int Z, int W>
+	inline float4 Shuffle(float4 v) {
+		return Set(vgetq_lane_f32(v, X), vgetq_lane_f32(v, Y), vgetq_lane_f32(v, Z), vgetq_lane_f32(v, W));
+	}
+
+	inline float GetX(float4 v) { return vgetq_lane_f32(v, 0); }
+
+#else
+	struct float4 {
+		float v[4];
+	};
+
+	inline float4 Load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+	inline void Store(float* p, float4 v) { p[0] = v.v[0]; p[1] = v.v[1]; p[2] = v.v[2]; p[3] = v.v[3]; }
+	inline float4 Set(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+	inline float4 Splat(float s) { return { { s, s, s, s } }; }
+	inline float4 Zero() { return { { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+
+	template <typename Op>
+	inline float4 PerLane(float4 a, float4 b, Op op) {
+		return { { op(a.v[0], b.v[0]), op(a.v[1], b.v[1]), op(a.v[2], b.v[2]), op(a.v[3], b.v[3]) } };
+	}
+	inline float4 Add(float4 a, float4 b) { return PerLane(a, b, [](float x, float y) { return x + y; }); }
+	inline float4 Sub(float4 a, float4 b) { return PerLane(a, b, [](float x, float y) { return x - y; }); }
+	inline float4 Mul(float4 a, float4 b) { return PerLane(a, b, [](float x, float y) { return x * y; }); }
+	inline float4 Div(float4 a, float4 b) { return PerLane(a, b, [](float x, float y) { return x / y; }); }
+	inline float4 Min(float4 a, float4 b) { return PerLane(a, b, [](float x, float y) { return x < y ? x : y; }); }
+	inline float4 Max(float4 a, float4 b) { return PerLane(a, b, [](float x, float y) { return x > y ? x : y; }); }
+	inline float4 MulAdd(float4 a, float4 b, float4 c) { return Add(Mul(a, b), c); }
+
+	template <int X, int Y, int Z, int W>
+	inline float4 Shuffle(float4 v) { return { { v.v[X], v.v[Y], v.v[Z], v.v[W] } }; }
+
+	inline float GetX(float4 v) { return v.v[0]; }
+#endif
+
+	inline float4 SplatX(float4 v) { return Shuffle<0, 0, 0, 0>(v); }
+	inline float4 SplatY(float4 v) { return Shuffle<1, 1, 1, 1>(v); }
+	inline float4 SplatZ(float4 v) { return Shuffle<2, 2, 2, 2>(v); }
+	inline float4 SplatW(float4 v) { return Shuffle<3, 3, 3, 3>(v); }
+
+	// sum of all four lanes, in every lane
+	inline float4 HorizontalSum(float4 v) {
+		float4 t = Add(v, Shuffle<1, 0, 3, 2>(v));
+		return Add(t, Shuffle<2, 3, 0, 1>(t));
+	}
+
+}
\ No newline at end of file
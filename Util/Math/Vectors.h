@@ -1,13 +1,74 @@
 #pragma once
+#include <cmath>
+#include "Simd.h"
+
+// Storage types, kept tightly packed so they can be used in vertex and constant buffer layouts.
+// Vec4 goes through SIMD registers for arithmetic, Vec2/Vec3 are left to the compiler.
 
 struct Vec2 {
 	float x, y;
+
+	constexpr Vec2() : x{ 0.0f }, y{ 0.0f } {}
+	constexpr Vec2(float x, float y) : x{ x }, y{ y } {}
 };
 
 struct Vec3 {
 	float x, y, z;
+
+	constexpr Vec3() : x{ 0.0f }, y{ 0.0f }, z{ 0.0f } {}
+	constexpr Vec3(float x, float y, float z) : x{ x }, y{ y }, z{ z } {}
+	constexpr explicit Vec3(float s) : x{ s }, y{ s }, z{ s } {}
+
+	constexpr Vec3 operator-() const { return { -x, -y, -z }; }
+	constexpr Vec3& operator+=(const Vec3& o) { x += o.x; y += o.y; z += o.z; return *this; }
+	constexpr Vec3& operator-=(const Vec3& o) { x -= o.x; y -= o.y; z -= o.z; return *this; }
+	constexpr Vec3& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
 };
 
+constexpr Vec3 operator+(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+constexpr Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+constexpr Vec3 operator*(const Vec3& a, const Vec3& b) { return { a.x * b.x, a.y * b.y, a.z * b.z }; }
+constexpr Vec3 operator*(const Vec3& v, float s) { return { v.x * s, v.y * s, v.z * s }; }
+constexpr Vec3 operator*(float s, const Vec3& v) { return v * s; }
+constexpr Vec3 operator/(const Vec3& v, float s) { return { v.x / s, v.y / s, v.z / s }; }
+constexpr bool operator==(const Vec3& a, const Vec3& b) { return a.x == b.x && a.y == b.y && a.z == b.z; }
+constexpr bool operator!=(const Vec3& a, const Vec3& b) { return !(a == b); }
+
+constexpr float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+constexpr Vec3 Cross(const Vec3& a, const Vec3& b) {
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+constexpr Vec3 Min(const Vec3& a, const Vec3& b) {
+	return { a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z };
+}
+constexpr Vec3 Max(const Vec3& a, const Vec3& b) {
+	return { a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z };
+}
+constexpr Vec3 Lerp(const Vec3& a, const Vec3& b, float t) { return a + (b - a) * t; }
+inline float Length(const Vec3& v) { return std::sqrt(Dot(v, v)); }
+inline Vec3 Normalize(const Vec3& v) {
+	float len = Length(v);
+	return len > 0.0f ? v / len : v;
+}
+
 struct Vec4 {
 	float x, y, z, w;
-};
\ No newline at end of file
+
+	constexpr Vec4() : x{ 0.0f }, y{ 0.0f }, z{ 0.0f }, w{ 0.0f } {}
+	constexpr Vec4(float x, float y, float z, float w) : x{ x }, y{ y }, z{ z }, w{ w } {}
+	constexpr Vec4(const Vec3& v, float w) : x{ v.x }, y{ v.y }, z{ v.z }, w{ w } {}
+
+	constexpr Vec3 xyz() const { return { x, y, z }; }
+
+	simd::float4 Load() const { return simd::Load(&x); }
+	static Vec4 From(simd::float4 v) { Vec4 r{}; simd::Store(&r.x, v); return r; }
+};
+
+inline Vec4 operator+(const Vec4& a, const Vec4& b) { return Vec4::From(simd::Add(a.Load(), b.Load())); }
+inline Vec4 operator-(const Vec4& a, const Vec4& b) { return Vec4::From(simd::Sub(a.Load(), b.Load())); }
+inline Vec4 operator*(const Vec4& a, const Vec4& b) { return Vec4::From(simd::Mul(a.Load(), b.Load())); }
+inline Vec4 operator*(const Vec4& v, float s) { return Vec4::From(simd::Mul(v.Load(), simd::Splat(s))); }
+inline Vec4 operator*(float s, const Vec4& v) { return v * s; }
+
+inline float Dot(const Vec4& a, const Vec4& b) { return simd::GetX(simd::HorizontalSum(simd::Mul(a.Load(), b.Load()))); }
+inline float Length(const Vec4& v) { return std::sqrt(Dot(v, v)); }
\ No newline at end of file
@@ -1,7 +1,92 @@
 #pragma once
+#include <cstdint>
+#include "Half.h"
 #include "Vectors.h"
 
 struct BasicVertex {
 	Vec3 Pos;
 	Vec4 Color;
+};
+
+// BasicVertex quantized for drawing, 12 bytes instead of 28: half float position
+// (w is padding, there is no three component 16 bit format) and UNORM8 color
+struct PackedVertex {
+	uint16_t Pos[4];
+	uint8_t Color[4];
+};
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex is an input layout");
+
+enum class VertexFormat : uint32_t {
+	Basic,  // BasicVertex
+	Packed, // PackedVertex
+};
+
+constexpr uint32_t VertexStride(VertexFormat format) {
+	return format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(BasicVertex);
+}
+
+inline uint8_t PackUnorm8(float value) {
+	const float clamped = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+	return static_cast<uint8_t>(clamped * 255.0f + 0.5f);
+}
+
+// positions past HalfMax become infinity and lose precision far from the origin,
+// the caller checks the range and error first (see OptimizeMesh)
+inline PackedVertex PackVertex(const BasicVertex& vertex) {
+	return {
+		{ FloatToHalf(vertex.Pos.x), FloatToHalf(vertex.Pos.y), FloatToHalf(vertex.Pos.z), 0 },
+		{ PackUnorm8(vertex.Color.x), PackUnorm8(vertex.Color.y), PackUnorm8(vertex.Color.z), PackUnorm8(vertex.Color.w) } };
+}
+
+// one level of detail, a range of the index buffer; every level indexes the same vertices
+struct MeshLod {
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	float error; // object space distance the level may deviate from the full mesh, 0 for the full mesh
+};
+static_assert(sizeof(MeshLod) == 12, "MeshLod is stored in mesh files");
+inline constexpr uint32_t MaxMeshLods = 8;
+
+// vertices and indices of a mesh in whichever format they are stored, only read during the call they are passed to
+struct MeshData {
+	const void* vertices{ nullptr };
+	uint32_t vertexCount{};
+	VertexFormat vertexFormat{ VertexFormat::Basic };
+	const void* indices{ nullptr };
+	uint32_t indexCount{};
+	uint32_t indexSize{ sizeof(uint32_t) }; // 2 or 4
+	// finest first, no table is a single level covering every index
+	const MeshLod* lods{ nullptr };
+	uint32_t lodCount{};
+
+	MeshData() = default;
+	MeshData(const BasicVertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
+		: vertices{ vertices }, vertexCount{ vertexCount }, indices{ indices }, indexCount{ indexCount } {}
+
+	uint32_t VertexBytes() const { return vertexCount * VertexStride(vertexFormat); }
+	uint32_t IndexBytes() const { return indexCount * indexSize; }
+
+	uint32_t LodCount() const { return lodCount > 0 ? lodCount : 1; }
+	MeshLod Lod(uint32_t level) const { return lodCount > 0 ? lods[level] : MeshLod{ 0, indexCount, 0.0f }; }
+
+	uint32_t Index(uint32_t i) const {
+		return indexSize == sizeof(uint16_t) ? static_cast<const uint16_t*>(indices)[i] : static_cast<const uint32_t*>(indices)[i];
+	}
+
+	/* decoded vertex attributes, for the CPU side */
+	Vec3 Position(uint32_t i) const {
+		if (vertexFormat == VertexFormat::Packed) {
+			const PackedVertex& v = static_cast<const PackedVertex*>(vertices)[i];
+			return { HalfToFloat(v.Pos[0]), HalfToFloat(v.Pos[1]), HalfToFloat(v.Pos[2]) };
+		}
+		return static_cast<const BasicVertex*>(vertices)[i].Pos;
+	}
+	Vec4 Color(uint32_t i) const {
+		if (vertexFormat == VertexFormat::Packed) {
+			const PackedVertex& v = static_cast<const PackedVertex*>(vertices)[i];
+			constexpr float scale = 1.0f / 255.0f;
+			return { v.Color[0] * scale, v.Color[1] * scale, v.Color[2] * scale, v.Color[3] * scale };
+		}
+		return static_cast<const BasicVertex*>(vertices)[i].Color;
+	}
 };
\ No newline at end of file
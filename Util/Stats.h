@@ -0,0 +1,13 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// nearest-rank percentile, p in [0, 100], samples must be sorted ascending
+inline float Percentile(const std::vector<float>& sorted, float p) {
+	if (sorted.empty()) {
+		return 0.0f;
+	}
+	size_t rank = static_cast<size_t>(std::ceil(p / 100.0f * static_cast<float>(sorted.size())));
+	return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
\ No newline at end of file
@@ -1,12 +1,13 @@
-cbuffer ViewMatrix
-{
-    float4x4 gWorldViewProj;
-};
-
 struct VS_Input
 {
     float3 pos : POSITION;
     float4 color : COLOR;
+
+    // per instance worldViewProj, row vector convention
+    float4 transform0 : INSTANCE_TRANSFORM0;
+    float4 transform1 : INSTANCE_TRANSFORM1;
+    float4 transform2 : INSTANCE_TRANSFORM2;
+    float4 transform3 : INSTANCE_TRANSFORM3;
 };
 
 struct VS_Output
@@ -18,11 +19,11 @@ struct VS_Output
 VS_Output vs_main(VS_Input input)
 {
     VS_Output output;
-    output.position = float4(input.pos, 1.0f);
     output.color = input.color;
     
     // transform position
-    output.position = mul(float4(input.pos, 1.0f), gWorldViewProj);
+    float4x4 worldViewProj = float4x4(input.transform0, input.transform1, input.transform2, input.transform3);
+    output.position = mul(float4(input.pos, 1.0f), worldViewProj);
 
     return output;
 }
\ No newline at end of file